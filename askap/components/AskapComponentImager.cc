@@ -36,8 +36,16 @@
 // System includes
 #include <cmath>
 #include <limits>
+#include <map>
 #include <algorithm>
 #include <typeinfo>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <exception>
+#include <chrono>
 
 // ASKAPsoft includes
 #include "askap/askap/AskapLogging.h"
@@ -45,12 +53,16 @@
 #include "casacore/casa/aipstype.h"
 #include "casacore/casa/Arrays/IPosition.h"
 #include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Matrix.h"
+#include "casacore/casa/Arrays/Array.h"
+#include "casacore/casa/Arrays/Slicer.h"
 #include "casacore/casa/Quanta/MVAngle.h"
 #include "casacore/casa/Quanta/MVDirection.h"
 #include "casacore/casa/Quanta/MVFrequency.h"
 #include "casacore/scimath/Functionals/Gaussian2D.h"
-#include "casacore/scimath/Functionals/Gaussian1D.h"
+#include "casacore/scimath/Mathematics/GaussianBeam.h"
 #include "casacore/images/Images/ImageInterface.h"
+#include "casacore/images/Images/SubImage.h"
 #include "casacore/measures/Measures/Stokes.h"
 #include "casacore/measures/Measures/MDirection.h"
 #include "casacore/measures/Measures/MFrequency.h"
@@ -66,27 +78,967 @@
 #include "components/ComponentModels/PointShape.h"
 #include "components/ComponentModels/GaussianShape.h"
 #include "components/ComponentModels/DiskShape.h"
+#include "components/ComponentModels/TwoSidedShape.h"
 #include "casacore/coordinates/Coordinates/CoordinateUtil.h"
 #include "casacore/coordinates/Coordinates/CoordinateSystem.h"
 #include "casacore/coordinates/Coordinates/DirectionCoordinate.h"
 #include "casacore/coordinates/Coordinates/SpectralCoordinate.h"
 
+// Local package includes
+#include "ComponentCatalogue.h"
+#include "ComponentFluxTable.h"
+#include "ComponentIndex.h"
+#include "DiskEvaluator.h"
+#include "FootprintCache.h"
+#include "GaussianRowEvaluator.h"
+#include "PixelPositionCache.h"
+#include "ProjectionStats.h"
+#include "SparseModel.h"
+
 ASKAP_LOGGER(logger, ".AskapComponentImager");
 
 using namespace askap;
 using namespace askap::components;
 using namespace casacore;
 
+namespace {
+
+/// The approximate memory (in bytes) used for the per plane flux values of
+/// a block of components. This bounds the number of components whose
+/// footprints are held in memory at once.
+const size_t BLOCK_FLUX_MEMORY = 64 * 1024 * 1024;
+
+/// The largest ratio of a gaussian's peak to its cutoff which is allowed
+/// for when culling components with a ComponentIndex, for the policies
+/// which depend on the flux
+const double MAX_CUTOFF_RATIO = 1.e30;
+
+/// @return the number of standard deviations beyond which a gaussian is
+/// cut off, for culling with a ComponentIndex
+double cullingSigmas(const askap::components::ProjectionOptions& options)
+{
+    switch (options.cutoffPolicy) {
+        case askap::components::ProjectionOptions::RELATIVE_TO_PEAK:
+            return sqrt(-2. * log(options.cutoffValue));
+        case askap::components::ProjectionOptions::N_SIGMA:
+            return options.cutoffValue;
+        default:
+            return sqrt(2. * log(MAX_CUTOFF_RATIO));
+    }
+}
+
+/// A component which has been prepared for rendering
 template <class T>
-void AskapComponentImager::project(casacore::ImageInterface<T>& image,
-                                   const casacore::ComponentList& list, const unsigned int term)
+struct PreparedComponent {
+    /// The shape of the component
+    casacore::ComponentType::Shape shape;
+
+    /// The unit flux gaussian function, for gaussian shapes only
+    Gaussian2D<T> gauss;
+
+    /// The unit flux disk, for disk shapes only
+    askap::components::DiskEvaluator disk;
+
+    /// The unit flux footprint of the component
+    askap::components::ComponentFootprint footprint;
+
+    /// The flux in each image plane being rendered, indexed
+    /// ((termIdx * nFreqs + freqIdx) * nStokes + polIdx)
+    std::vector<double> flux;
+
+    /// The largest absolute flux in any image plane
+    double maxFlux;
+
+    /// True if the footprint of the component overlaps the image
+    bool onImage;
+
+    /// The number of pixels evaluated for the footprint
+    size_t evaluated;
+};
+
+/// Adds the time between construction and destruction (or stop()) to a
+/// total, if one is given. With no total the clock is never read.
+class PhaseTimer {
+    public:
+        explicit PhaseTimer(double* total) : itsTotal(total)
+        {
+            if (itsTotal) {
+                itsStart = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~PhaseTimer()
+        {
+            stop();
+        }
+
+        void stop()
+        {
+            if (itsTotal) {
+                const std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - itsStart;
+                *itsTotal += elapsed.count();
+                itsTotal = 0;
+            }
+        }
+
+    private:
+        double* itsTotal;
+        std::chrono::steady_clock::time_point itsStart;
+};
+
+/// @return the index of a component shape in the ProjectionStats counters,
+///         or N_SHAPES for a shape which is not rendered
+ProjectionStats::Shape statsShape(const casacore::ComponentType::Shape shape)
+{
+    switch (shape) {
+        case casacore::ComponentType::POINT:
+            return ProjectionStats::POINT;
+        case casacore::ComponentType::GAUSSIAN:
+            return ProjectionStats::GAUSSIAN;
+        case casacore::ComponentType::DISK:
+            return ProjectionStats::DISK;
+        default:
+            return ProjectionStats::N_SHAPES;
+    }
+}
+
+/// Spectral scale policies for fillFlux(). Each gives the scale factor for a
+/// channel from the log of the ratio of its frequency to the reference
+/// frequency, for components of one ComponentFluxTable::SpectralKind. The
+/// results are identical to ComponentFluxTable::spectralScale().
+struct FlatScale {
+    static double scale(const double, const double, const double)
+    {
+        return 1.0;
+    }
+};
+
+struct PowerLawScale {
+    static double scale(const double alpha, const double, const double logRatio)
+    {
+        return exp(alpha * logRatio);
+    }
+};
+
+struct CurvedScale {
+    static double scale(const double alpha, const double beta, const double logRatio)
+    {
+        return exp((alpha + beta * logRatio) * logRatio);
+    }
+};
+
+/// Fill the flux in each image plane, and the largest absolute flux, for a
+/// batch of rows of the flux table which all have the spectral kind of the
+/// Scale policy, so there is no test of the spectral model in the loops.
+/// Row n of the table is prepared in block[n - blockStart].
+template <class Scale, class T>
+void fillFlux(const askap::components::ComponentFluxTable& table,
+              const std::vector<size_t>& rows, const size_t blockStart,
+              const std::vector<double>& logFreqs,
+              const std::vector<unsigned int>& terms,
+              const Vector<Stokes::StokesTypes>& stokes,
+              std::vector<PreparedComponent<T> >& block)
+{
+    const size_t nTerms = terms.size();
+    const size_t nFreqs = logFreqs.size();
+    const uInt nStokes = stokes.nelements();
+    std::vector<double> spectralScale(nFreqs);
+    std::vector<double> polFlux(nStokes);
+    for (size_t r = 0; r < rows.size(); ++r) {
+        const size_t n = rows[r];
+        PreparedComponent<T>& pc = block[n - blockStart];
+        const double alpha = table.alpha(n);
+        const double beta = table.beta(n);
+        const double logRefFreq = table.logRefFrequency(n);
+        for (size_t freqIdx = 0; freqIdx < nFreqs; ++freqIdx) {
+            spectralScale[freqIdx] = Scale::scale(alpha, beta, logFreqs[freqIdx] - logRefFreq);
+        }
+
+        pc.flux.resize(nTerms * nFreqs * nStokes);
+        double maxFlux = 0.0;
+        for (size_t termIdx = 0; termIdx < nTerms; ++termIdx) {
+            const double taylorFactor = table.taylorFactor(n, terms[termIdx]);
+            for (uInt polIdx = 0; polIdx < nStokes; ++polIdx) {
+                polFlux[polIdx] = taylorFactor * table.flux(n, stokes(polIdx));
+            }
+            double* termFlux = &pc.flux[termIdx * nFreqs * nStokes];
+            for (size_t freqIdx = 0; freqIdx < nFreqs; ++freqIdx) {
+                for (uInt polIdx = 0; polIdx < nStokes; ++polIdx) {
+                    const double value = spectralScale[freqIdx] * polFlux[polIdx];
+                    termFlux[freqIdx * nStokes + polIdx] = value;
+                    maxFlux = std::max(maxFlux, std::abs(value));
+                }
+            }
+        }
+        pc.maxFlux = maxFlux;
+    }
+}
+
+/// The most polarisations an image can have, which are Stokes I, Q, U and V
+const uInt MAX_POLS = 4;
+
+/// The layout of the image axes. The positions and shapes of slices, and the
+/// offsets between their elements, are found from this rather than by
+/// searching the axes for each slice.
+struct SliceLayout {
+    SliceLayout(const Int latAxis, const Int lonAxis, const Int freqAxis,
+                const Int polAxis, const uInt nPols)
+        : latAxis(latAxis), lonAxis(lonAxis), freqAxis(freqAxis),
+          polAxis(polAxis), nPols(nPols),
+          nDim(polAxis >= 0 ? 4 : 3) {}
+
+    /// @return the position of pixel (lat, lon) of a channel, in the first
+    ///         polarisation
+    IPosition start(const int lat, const int lon, const uInt chan) const
+    {
+        IPosition pos(nDim, 0);
+        pos(latAxis) = lat;
+        pos(lonAxis) = lon;
+        pos(freqAxis) = chan;
+        return pos;
+    }
+
+    /// @return the shape of a slice of every polarisation of the given
+    ///         pixels and channels
+    IPosition shape(const uInt nLat, const uInt nLon, const uInt nChans) const
+    {
+        IPosition length(nDim, 1);
+        length(latAxis) = nLat;
+        length(lonAxis) = nLon;
+        length(freqAxis) = nChans;
+        if (polAxis >= 0) {
+            length(polAxis) = nPols;
+        }
+        return length;
+    }
+
+    /// Find the offsets between adjacent elements along each axis of a
+    /// slice, as returned by shape(). The polarisation stride is zero
+    /// if there is no polarisation axis.
+    void strides(const uInt nLat, const uInt nLon, const uInt nChans,
+                 ssize_t& latStride, ssize_t& lonStride,
+                 ssize_t& freqStride, ssize_t& polStride) const
+    {
+        polStride = 0;
+        ssize_t stride = 1;
+        for (Int axis = 0; axis < static_cast<Int>(nDim); ++axis) {
+            if (axis == latAxis) {
+                latStride = stride;
+                stride *= nLat;
+            } else if (axis == lonAxis) {
+                lonStride = stride;
+                stride *= nLon;
+            } else if (axis == freqAxis) {
+                freqStride = stride;
+                stride *= nChans;
+            } else if (axis == polAxis) {
+                polStride = stride;
+                stride *= nPols;
+            }
+        }
+    }
+
+    Int latAxis;
+    Int lonAxis;
+    Int freqAxis;
+    Int polAxis;
+    uInt nPols;
+    uInt nDim;
+};
+
+/// The polarisations of a plane with a non-zero flux. A footprint is added to
+/// all of them in a single pass, so each of its values is read once.
+struct ActivePols {
+    ActivePols(const double* planeFlux, const uInt nPols, const ssize_t polStride) : n(0)
+    {
+        for (uInt polIdx = 0; polIdx < nPols; ++polIdx) {
+            if (planeFlux[polIdx] != 0.0) {
+                index[n] = polIdx;
+                offset[n] = polIdx * polStride;
+                flux[n] = planeFlux[polIdx];
+                ++n;
+            }
+        }
+    }
+
+    /// The number of polarisations with a non-zero flux
+    uInt n;
+
+    /// For each of these, the polarisation index, the offset of its plane
+    /// and its flux
+    uInt index[MAX_POLS];
+    ssize_t offset[MAX_POLS];
+    double flux[MAX_POLS];
+};
+
+/// Add a footprint to N polarisations, as for accumulateFootprint(). The
+/// number of polarisations is a template parameter so the inner loop
+/// over them is unrolled.
+template <uInt N, class T>
+void accumulatePols(const askap::components::ComponentFootprint& footprint,
+                    const ActivePols& pols, T* data,
+                    const ssize_t latStride, const ssize_t lonStride)
+{
+    const uInt nLat = footprint.nLat();
+    for (uInt y = 0; y < footprint.nLon(); ++y) {
+        T* row = data + y * lonStride;
+        const double* values = footprint.data() + y * nLat;
+        for (uInt x = 0; x < nLat; ++x) {
+            T* pixel = row + x * latStride;
+            const double value = values[x];
+            for (uInt k = 0; k < N; ++k) {
+                pixel[pols.offset[k]] = pixel[pols.offset[k]] + (pols.flux[k] * value);
+            }
+        }
+    }
+}
+
+/// Add a footprint to N polarisations with compensated summation, as for
+/// accumulateFootprintCompensated()
+template <uInt N, class T>
+void accumulatePolsCompensated(const askap::components::ComponentFootprint& footprint,
+                               const ActivePols& pols, T* data, T* compensation,
+                               const ssize_t latStride, const ssize_t lonStride)
+{
+    const uInt nLat = footprint.nLat();
+    for (uInt y = 0; y < footprint.nLon(); ++y) {
+        T* row = data + y * lonStride;
+        T* compRow = compensation + y * lonStride;
+        const double* values = footprint.data() + y * nLat;
+        for (uInt x = 0; x < nLat; ++x) {
+            T* pixel = row + x * latStride;
+            T* comp = compRow + x * latStride;
+            for (uInt k = 0; k < N; ++k) {
+                const ssize_t o = pols.offset[k];
+                const T sum = pixel[o];
+                const double value = (pols.flux[k] * values[x]) - comp[o];
+                const T total = static_cast<T>(sum + value);
+                comp[o] = static_cast<T>((static_cast<double>(total) - sum) - value);
+                pixel[o] = total;
+            }
+        }
+    }
+}
+
+/// Add a footprint, scaled by the flux of each polarisation, to a single
+/// channel of an in-memory array. The data pointer is the element of the
+/// first pixel of the footprint in the first polarisation, and the strides
+/// are the offsets between adjacent elements along each axis. Each pixel
+/// of the footprint is added to every polarisation with a non-zero flux
+/// before moving on to the next.
+template <class T>
+void accumulateFootprint(const askap::components::ComponentFootprint& footprint,
+                         const double* flux, const uInt nPols, T* data,
+                         const ssize_t latStride, const ssize_t lonStride,
+                         const ssize_t polStride)
 {
-    if (list.nelements() == 0) {
+    const ActivePols pols(flux, nPols, polStride);
+    switch (pols.n) {
+        case 1:
+            accumulatePols<1>(footprint, pols, data, latStride, lonStride);
+            break;
+        case 2:
+            accumulatePols<2>(footprint, pols, data, latStride, lonStride);
+            break;
+        case 3:
+            accumulatePols<3>(footprint, pols, data, latStride, lonStride);
+            break;
+        case 4:
+            accumulatePols<4>(footprint, pols, data, latStride, lonStride);
+            break;
+        default:
+            break;
+    }
+}
+
+/// Add a footprint to a single channel of an in-memory array, as for
+/// accumulateFootprint(), with compensated (Kahan) summation. The
+/// compensation array has the layout of the data, and holds the rounding
+/// error of the last addition to each element, which is taken from the next.
+/// The true sum is the data less the compensation.
+template <class T>
+void accumulateFootprintCompensated(const askap::components::ComponentFootprint& footprint,
+                                    const double* flux, const uInt nPols,
+                                    T* data, T* compensation,
+                                    const ssize_t latStride, const ssize_t lonStride,
+                                    const ssize_t polStride)
+{
+    const ActivePols pols(flux, nPols, polStride);
+    switch (pols.n) {
+        case 1:
+            accumulatePolsCompensated<1>(footprint, pols, data, compensation,
+                                         latStride, lonStride);
+            break;
+        case 2:
+            accumulatePolsCompensated<2>(footprint, pols, data, compensation,
+                                         latStride, lonStride);
+            break;
+        case 3:
+            accumulatePolsCompensated<3>(footprint, pols, data, compensation,
+                                         latStride, lonStride);
+            break;
+        case 4:
+            accumulatePolsCompensated<4>(footprint, pols, data, compensation,
+                                         latStride, lonStride);
+            break;
+        default:
+            break;
+    }
+}
+
+/// Add a footprint, scaled by the given flux, to all polarisations of a
+/// single channel. The bounding box of the footprint is read from the
+/// image with one getSlice() and written back with one putSlice().
+///
+/// This may be called concurrently for different channels. Access to
+/// the image is serialised by the ioMutex, and the footprint is added
+/// to a private copy of the slice outside of the lock. The buffer is
+/// scratch space for the slice, which may be reused between calls.
+template <class T>
+void addFootprint(casacore::ImageInterface<T>& image,
+                  const askap::components::ComponentFootprint& footprint,
+                  const SliceLayout& layout, const uInt freqIdx,
+                  const double* flux, Array<T>& buffer, std::mutex& ioMutex)
+{
+    // The slice covers the bounding box of the footprint, and all
+    // polarisations of this channel
+    const IPosition start = layout.start(footprint.startLat(), footprint.startLon(), freqIdx);
+    const IPosition shape = layout.shape(footprint.nLat(), footprint.nLon(), 1);
+    {
+        // The slice may reference the image data (e.g. for an in-memory
+        // image), so make it unique while the lock is held
+        std::lock_guard<std::mutex> lock(ioMutex);
+        image.getSlice(buffer, start, shape);
+        buffer.unique();
+    }
+
+    ssize_t latStride, lonStride, freqStride, polStride;
+    layout.strides(footprint.nLat(), footprint.nLon(), 1,
+                   latStride, lonStride, freqStride, polStride);
+
+    Bool deleteIt;
+    T* data = buffer.getStorage(deleteIt);
+    accumulateFootprint(footprint, flux, layout.nPols, data, latStride, lonStride, polStride);
+    buffer.putStorage(data, deleteIt);
+
+    std::lock_guard<std::mutex> lock(ioMutex);
+    image.putSlice(buffer, start);
+}
+
+/// The in-memory copy of a block of channels of each taylor term image
+template <class T>
+struct ChannelBlock {
+    ChannelBlock() : chanStart(0), nChans(0) {}
+
+    /// The first channel and the number of channels
+    uInt chanStart;
+    uInt nChans;
+
+    /// For each image, the block and its storage
+    std::vector<Array<T> > buffers;
+    std::vector<T*> data;
+    std::vector<Bool> deleteIt;
+};
+
+/// Read all polarisations of a block of channels of each image, and take
+/// the storage of each so it can be written in place
+template <class T>
+void readChannelBlock(const std::vector<casacore::ImageInterface<T>*>& images,
+                      const SliceLayout& layout, const uInt nLat, const uInt nLon,
+                      const uInt chanStart, const uInt nChans, ChannelBlock<T>& chanBlock)
+{
+    const size_t nImages = images.size();
+    chanBlock.chanStart = chanStart;
+    chanBlock.nChans = nChans;
+    chanBlock.buffers.resize(nImages);
+    chanBlock.data.resize(nImages);
+    chanBlock.deleteIt.resize(nImages);
+    const IPosition start = layout.start(0, 0, chanStart);
+    const IPosition shape = layout.shape(nLat, nLon, nChans);
+    for (size_t i = 0; i < nImages; ++i) {
+        images[i]->getSlice(chanBlock.buffers[i], start, shape);
+        chanBlock.buffers[i].unique();
+        Bool deleteIt;
+        chanBlock.data[i] = chanBlock.buffers[i].getStorage(deleteIt);
+        chanBlock.deleteIt[i] = deleteIt;
+    }
+}
+
+/// Write a block read by readChannelBlock() back to each image
+template <class T>
+void writeChannelBlock(const std::vector<casacore::ImageInterface<T>*>& images,
+                       const SliceLayout& layout, ChannelBlock<T>& chanBlock)
+{
+    const IPosition start = layout.start(0, 0, chanBlock.chanStart);
+    for (size_t i = 0; i < images.size(); ++i) {
+        chanBlock.buffers[i].putStorage(chanBlock.data[i], chanBlock.deleteIt[i]);
+        images[i]->putSlice(chanBlock.buffers[i], start);
+    }
+}
+
+/// Add a footprint, scaled by the flux of each polarisation, to a single
+/// channel of a sparse model. Pixels to which nothing is added get no entry.
+template <class T>
+void addSparseFootprint(askap::components::SparseModel<T>& model,
+                        const askap::components::ComponentFootprint& footprint,
+                        const uInt chan, const double* flux, const uInt nPols)
+{
+    const ActivePols pols(flux, nPols, 0);
+    for (uInt y = 0; y < footprint.nLon(); ++y) {
+        for (uInt x = 0; x < footprint.nLat(); ++x) {
+            const double unitValue = footprint(x, y);
+            if (unitValue == 0.0) {
+                continue;
+            }
+            for (uInt k = 0; k < pols.n; ++k) {
+                const double value = pols.flux[k] * unitValue;
+                if (value != 0.0) {
+                    model.add(chan, pols.index[k], footprint.startLat() + x,
+                              footprint.startLon() + y, value);
+                }
+            }
+        }
+    }
+}
+
+/// Convolve a gaussian with another, in place. The covariance of the result
+/// is the sum of the covariances, found here in units of FWHM squared. The
+/// axes are FWHMs and the position angles are those of the major axes, which
+/// lie along (-sin(pa), cos(pa)). A gaussian with zero axes is a point.
+void convolveGaussians(double& major, double& minor, double& pa,
+                       const double otherMajor, const double otherMinor,
+                       const double otherPa)
+{
+    double xx = 0.0;
+    double yy = 0.0;
+    double xy = 0.0;
+    const double axes[2][3] = {{major, minor, pa}, {otherMajor, otherMinor, otherPa}};
+    for (int i = 0; i < 2; ++i) {
+        const double majorSq = axes[i][0] * axes[i][0];
+        const double minorSq = axes[i][1] * axes[i][1];
+        const double s = sin(axes[i][2]);
+        const double c = cos(axes[i][2]);
+        xx += majorSq * s * s + minorSq * c * c;
+        yy += majorSq * c * c + minorSq * s * s;
+        xy -= (majorSq - minorSq) * s * c;
+    }
+    const double mean = 0.5 * (xx + yy);
+    const double diff = sqrt(0.25 * (yy - xx) * (yy - xx) + xy * xy);
+    major = sqrt(mean + diff);
+    minor = sqrt(std::max(0.0, mean - diff));
+    pa = (diff > 0.0) ? 0.5 * atan2(-2. * xy, yy - xx) : 0.0;
+}
+
+/// The constants of a one dimensional gaussian, which lies along the major
+/// axis of a 2D gaussian with zero minor axis. Points on the line are
+/// (xCenter + t.dx, yCenter + t.dy), where t is the distance from the centre
+/// in pixels, so the flux between t0 and t1 on the line is
+/// halfFlux * (erf(t1 * zScale) - erf(t0 * zScale)).
+struct LineGaussian {
+    template <class T>
+    explicit LineGaussian(const casacore::Gaussian2D<T>& gauss)
+        : xCenter(gauss.xCenter()), yCenter(gauss.yCenter()),
+          dx(-sin(gauss.PA())), dy(cos(gauss.PA())),
+          zScale(2. * sqrt(M_LN2) / gauss.majorAxis()),
+          halfFlux(0.5 * gauss.flux())
+    {
+        // Lines along a pixel axis are treated as exactly so, so they lie
+        // within a single row or column of pixels
+        if (fabs(dx) < 1.e-6) {
+            dx = 0.;
+            dy = (dy > 0.) ? 1. : -1.;
+        } else if (fabs(dy) < 1.e-6) {
+            dy = 0.;
+            dx = (dx > 0.) ? 1. : -1.;
+        }
+    }
+
+    /// Clip the line to the box [xmin, xmax) x [ymin, ymax).
+    /// @param[out] t0  the start of the section of the line within the box
+    /// @param[out] t1  the end of the section of the line within the box
+    /// @return false if the line does not cross the box
+    bool clip(const double xmin, const double xmax, const double ymin, const double ymax,
+              double& t0, double& t1) const
+    {
+        t0 = -std::numeric_limits<double>::infinity();
+        t1 = std::numeric_limits<double>::infinity();
+        return clipAxis(xCenter, dx, xmin, xmax, t0, t1) &&
+               clipAxis(yCenter, dy, ymin, ymax, t0, t1) && t1 > t0;
+    }
+
+    double xCenter;
+    double yCenter;
+    double dx;
+    double dy;
+    double zScale;
+    double halfFlux;
+
+    private:
+        static bool clipAxis(const double centre, const double d,
+                             const double lower, const double upper,
+                             double& t0, double& t1)
+        {
+            if (d == 0.) {
+                return centre >= lower && centre < upper;
+            }
+            const double ta = (lower - centre) / d;
+            const double tb = (upper - centre) / d;
+            t0 = std::max(t0, std::min(ta, tb));
+            t1 = std::min(t1, std::max(ta, tb));
+            return true;
+        }
+};
+
+/// Call func(i, slot) for each i in [0, n) using up to nThreads threads, one
+/// of which is the calling thread. Each thread has its own slot number in
+/// [0, nThreads), so func can use scratch space indexed by the slot without
+/// locking, and reuse it from one call to the next. Indices are handed out
+/// one at a time so the threads stay busy even when the work per index
+/// varies. If any call throws, no further indices are handed out and the
+/// first exception is rethrown in the calling thread once all threads have
+/// finished.
+template <class Func>
+void parallelForSlots(const unsigned int nThreads, const size_t n, Func func)
+{
+    if (nThreads <= 1 || n <= 1) {
+        for (size_t i = 0; i < n; ++i) {
+            func(i, 0);
+        }
         return;
     }
 
-    const CoordinateSystem& coords = image.coordinates();
-    const IPosition imageShape = image.shape();
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&](const unsigned int slot) {
+        try {
+            for (size_t i = next++; i < n; i = next++) {
+                func(i, slot);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next = n;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const size_t nWorkers = std::min(static_cast<size_t>(nThreads), n);
+    for (size_t t = 1; t < nWorkers; ++t) {
+        threads.push_back(std::thread(worker, static_cast<unsigned int>(t)));
+    }
+    worker(0);
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/// Call func(i) for each i in [0, n), as for parallelForSlots()
+template <class Func>
+void parallelFor(const unsigned int nThreads, const size_t n, Func func)
+{
+    parallelForSlots(nThreads, n, [&func](size_t i, unsigned int) { func(i); });
+}
+
+/// The estimated cost of evaluating one footprint
+struct FootprintCost {
+    /// The number of pixels which are evaluated
+    size_t pixels;
+
+    /// The number of rows, and whether they can be evaluated separately
+    uInt nRows;
+    bool splittable;
+};
+
+/// Either the whole footprints [begin, end) of a batch, or when endRow is
+/// non-zero, rows [firstRow, endRow) of the single footprint begin
+struct FootprintTask {
+    size_t begin;
+    size_t end;
+    uInt firstRow;
+    uInt endRow;
+    size_t pixels;
+
+    bool operator<(const FootprintTask& other) const { return pixels > other.pixels; }
+};
+
+/// The fewest pixels worth a task of their own, so tiny footprints are not
+/// handed out one at a time
+const size_t MIN_TASK_PIXELS = 4096;
+
+/// The number of tasks per thread aimed for, so the threads stay busy while
+/// the last tasks are finished
+const size_t TASKS_PER_THREAD = 8;
+
+/// Divide the evaluation of a batch of footprints into tasks of similar
+/// cost, for parallelForSlots(). The cost of a footprint is its number of
+/// pixels, which grows with the square of its cutoff, so a few extended
+/// components can dominate a batch the size of a block. Footprints costing
+/// more than the target are split into bands of rows, and consecutive small
+/// footprints are gathered into one task. The tasks are ordered from the most
+/// to the least costly, so the remaining tasks are small as the threads run
+/// out of work.
+void makeFootprintTasks(const std::vector<FootprintCost>& costs, const unsigned int nThreads,
+                        std::vector<FootprintTask>& tasks)
+{
+    tasks.clear();
+    if (costs.empty()) {
+        return;
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < costs.size(); ++i) {
+        total += costs[i].pixels;
+    }
+    const size_t target = (nThreads <= 1) ? total + 1
+                          : std::max(MIN_TASK_PIXELS, total / (nThreads * TASKS_PER_THREAD));
+
+    // The chunk of small footprints being gathered, which covers
+    // [chunk.begin, chunk.end) of the batch
+    FootprintTask chunk;
+    chunk.begin = 0;
+    chunk.end = 0;
+    chunk.firstRow = 0;
+    chunk.endRow = 0;
+    chunk.pixels = 0;
+    for (size_t i = 0; i < costs.size(); ++i) {
+        const FootprintCost& cost = costs[i];
+        if (cost.pixels < target || !cost.splittable || cost.nRows < 2) {
+            chunk.end = i + 1;
+            chunk.pixels += cost.pixels;
+            if (chunk.pixels >= target) {
+                tasks.push_back(chunk);
+                chunk.begin = chunk.end;
+                chunk.pixels = 0;
+            }
+            continue;
+        }
+
+        // Finish the chunk, which can't include this footprint
+        if (chunk.end > chunk.begin) {
+            tasks.push_back(chunk);
+        }
+        chunk.begin = i + 1;
+        chunk.end = i + 1;
+        chunk.pixels = 0;
+
+        const uInt nTiles = std::min(static_cast<size_t>(cost.nRows),
+                                     (cost.pixels + target - 1) / target);
+        const uInt rowsPerTile = (cost.nRows + nTiles - 1) / nTiles;
+        const size_t rowPixels = cost.pixels / cost.nRows;
+        for (uInt row = 0; row < cost.nRows; row += rowsPerTile) {
+            FootprintTask tile;
+            tile.begin = i;
+            tile.end = i + 1;
+            tile.firstRow = row;
+            tile.endRow = std::min(cost.nRows, row + rowsPerTile);
+            tile.pixels = rowPixels * (tile.endRow - tile.firstRow);
+            tasks.push_back(tile);
+        }
+    }
+    if (chunk.end > chunk.begin) {
+        tasks.push_back(chunk);
+    }
+    std::stable_sort(tasks.begin(), tasks.end());
+}
+
+/// Gives AskapComponentImager::projectTerms() access to the components of a
+/// ComponentList
+class ListComponents {
+    public:
+        explicit ListComponents(const casacore::ComponentList& list) : itsList(list) {}
+
+        /// @return the number of components
+        uInt nelements() const { return itsList.nelements(); }
+
+        /// @return the list, for the options which refer to one
+        const casacore::ComponentList* list() const { return &itsList; }
+
+        /// @return the shape of component i
+        casacore::ComponentType::Shape shape(const uInt i) const
+        {
+            return itsList.component(i).shape().type();
+        }
+
+        /// Get the axes, in radians, of a gaussian or disk component
+        void axes(const uInt i, double& majorAxis, double& minorAxis, double& pa) const
+        {
+            const TwoSidedShape& shape =
+                dynamic_cast<const TwoSidedShape&>(itsList.component(i).shape());
+            majorAxis = shape.majorAxisInRad();
+            minorAxis = shape.minorAxisInRad();
+            pa = shape.positionAngleInRad();
+        }
+
+        /// Convert the direction of component i to a pixel position
+        bool toPixel(const DirectionCoordinate& dirCoord, const uInt i,
+                     Vector<Double>& pixel) const
+        {
+            return dirCoord.toPixel(pixel, itsList.component(i).shape().refDirection());
+        }
+
+        /// The directions are converted to the reference frame of the image
+        void checkDirectionType(const DirectionCoordinate&) const {}
+
+        /// @return the flux table of the given components
+        ComponentFluxTable fluxTable(const std::vector<uInt>& indices,
+                                     const ProjectionOptions& options) const
+        {
+            return options.spectralModels
+                   ? ComponentFluxTable(itsList, indices, *options.spectralModels)
+                   : ComponentFluxTable(itsList, indices);
+        }
+
+    private:
+        const casacore::ComponentList& itsList;
+};
+
+/// Gives AskapComponentImager::projectTerms() access to the components of a
+/// ComponentCatalogue, as for ListComponents
+class CatalogueComponents {
+    public:
+        explicit CatalogueComponents(const ComponentCatalogue& catalogue)
+            : itsCatalogue(catalogue) {}
+
+        uInt nelements() const { return itsCatalogue.nelements(); }
+
+        const casacore::ComponentList* list() const { return 0; }
+
+        casacore::ComponentType::Shape shape(const uInt i) const
+        {
+            return itsCatalogue.shape(i);
+        }
+
+        void axes(const uInt i, double& majorAxis, double& minorAxis, double& pa) const
+        {
+            majorAxis = itsCatalogue.majorAxis()[i];
+            minorAxis = itsCatalogue.minorAxis()[i];
+            pa = itsCatalogue.positionAngle()[i];
+        }
+
+        bool toPixel(const DirectionCoordinate& dirCoord, const uInt i,
+                     Vector<Double>& pixel) const
+        {
+            return dirCoord.toPixel(pixel, MVDirection(itsCatalogue.ra()[i],
+                                                       itsCatalogue.dec()[i]));
+        }
+
+        /// The directions are not converted, so must be in the reference
+        /// frame of the image
+        void checkDirectionType(const DirectionCoordinate& dirCoord) const
+        {
+            ASKAPCHECK(dirCoord.directionType() == itsCatalogue.directionType(),
+                       "Catalogue directions must be in the reference frame of the image");
+        }
+
+        ComponentFluxTable fluxTable(const std::vector<uInt>& indices,
+                                     const ProjectionOptions&) const
+        {
+            return ComponentFluxTable(itsCatalogue, indices);
+        }
+
+    private:
+        const ComponentCatalogue& itsCatalogue;
+};
+
+}
+
+template <class T>
+void AskapComponentImager::project(casacore::ImageInterface<T>& image,
+                                   const casacore::ComponentList& list, const unsigned int term,
+                                   const ProjectionOptions& options)
+{
+    const std::vector<casacore::ImageInterface<T>*> images(1, &image);
+    const std::vector<unsigned int> terms(1, term);
+    projectTerms<T>(images, 0, terms, ListComponents(list), options);
+}
+
+template <class T>
+void AskapComponentImager::project(const std::vector<casacore::ImageInterface<T>*>& images,
+                                   const casacore::ComponentList& list,
+                                   const ProjectionOptions& options)
+{
+    std::vector<unsigned int> terms(images.size());
+    for (size_t t = 0; t < terms.size(); ++t) {
+        terms[t] = t;
+    }
+    projectTerms<T>(images, 0, terms, ListComponents(list), options);
+}
+
+template <class T>
+void AskapComponentImager::project(casacore::ImageInterface<T>& image,
+                                   const ComponentCatalogue& catalogue, const unsigned int term,
+                                   const ProjectionOptions& options)
+{
+    const std::vector<casacore::ImageInterface<T>*> images(1, &image);
+    const std::vector<unsigned int> terms(1, term);
+    projectTerms<T>(images, 0, terms, CatalogueComponents(catalogue), options);
+}
+
+template <class T>
+void AskapComponentImager::project(const std::vector<casacore::ImageInterface<T>*>& images,
+                                   const ComponentCatalogue& catalogue,
+                                   const ProjectionOptions& options)
+{
+    std::vector<unsigned int> terms(images.size());
+    for (size_t t = 0; t < terms.size(); ++t) {
+        terms[t] = t;
+    }
+    projectTerms<T>(images, 0, terms, CatalogueComponents(catalogue), options);
+}
+
+template <class T>
+void AskapComponentImager::project(SparseModel<T>& model,
+                                   const casacore::ComponentList& list, const unsigned int term,
+                                   const ProjectionOptions& options)
+{
+    const std::vector<casacore::ImageInterface<T>*> images;
+    const std::vector<unsigned int> terms(1, term);
+    projectTerms<T>(images, &model, terms, ListComponents(list), options);
+}
+
+template <class T, class Components>
+void AskapComponentImager::projectTerms(const std::vector<casacore::ImageInterface<T>*>& images,
+                                        SparseModel<T>* sparse,
+                                        const std::vector<unsigned int>& terms,
+                                        const Components& components,
+                                        const ProjectionOptions& options)
+{
+    if (sparse) {
+        ASKAPCHECK(images.empty() && terms.size() == 1,
+                   "A sparse model receives a single taylor term");
+    } else {
+        ASKAPCHECK(!images.empty() && images.size() == terms.size(),
+                   "There must be one image per taylor term");
+    }
+    for (size_t t = 0; t < images.size(); ++t) {
+        ASKAPCHECK(images[t] != 0, "Null image pointer");
+    }
+    if (components.nelements() == 0) {
+        return;
+    }
+    if (!components.list()) {
+        ASKAPCHECK(!options.componentIndex && !options.positionCache && !options.spectralModels,
+                   "The componentIndex, positionCache and spectralModels options "
+                   "need a component list");
+    }
+    ProjectionStats* const stats = options.stats;
+
+    // All of the images share the pixel grid of the first
+    const CoordinateSystem& coords = sparse ? sparse->coordinates() : images[0]->coordinates();
+    const IPosition imageShape = sparse ? sparse->shape() : images[0]->shape();
+    for (size_t t = 1; t < images.size(); ++t) {
+        ASKAPCHECK(images[t]->shape().isEqual(imageShape),
+                   "All images must have the same shape");
+        ASKAPCHECK(images[t]->coordinates().near(coords),
+                   "All images must have the same coordinate system");
+    }
+    const size_t nTerms = terms.size();
 
     // Find which pixel axes correspond to the DirectionCoordinate in the
     // supplied coordinate system
@@ -104,6 +1056,7 @@ void AskapComponentImager::project(casacore::ImageInterface<T>& image,
     ASKAPCHECK(dirCoord.nWorldAxes() == 2,
                "DirectionCoordinate has unsupported number of world axes");
     dirCoord.setWorldAxisUnits(Vector<String>(2, "rad"));
+    components.checkDirectionType(dirCoord);
 
     // Check if there is a Stokes Axes and if so which polarizations.
     // Otherwise only image the I polarisation.
@@ -115,6 +1068,7 @@ void AskapComponentImager::project(casacore::ImageInterface<T>& image,
 
     if (polAxis >= 0) {
         ASKAPASSERT(static_cast<uInt>(imageShape(polAxis)) == nStokes);
+        ASKAPCHECK(nStokes <= MAX_POLS, "Stokes axis can have at most " << MAX_POLS << " pols");
         // If there is a Stokes axis it can only contain Stokes::I,Q,U,V pols.
         for (uInt p = 0; p < nStokes; ++p) {
             ASKAPCHECK(stokes(p) == Stokes::I || stokes(p) == Stokes::Q ||
@@ -125,12 +1079,60 @@ void AskapComponentImager::project(casacore::ImageInterface<T>& image,
         ASKAPLOG_DEBUG_STR(logger, "No polarisation axis, assuming Stokes I");
     }
 
-    // Get the frequency axis and get the all the frequencies
-    // as a Vector<MVFrequency>.
+    switch (options.cutoffPolicy) {
+        case ProjectionOptions::RELATIVE_TO_PEAK:
+            ASKAPCHECK(options.cutoffValue > 0.0 && options.cutoffValue < 1.0,
+                       "Relative cutoff must be in the range (0, 1)");
+            break;
+        case ProjectionOptions::ABSOLUTE_FLUX:
+        case ProjectionOptions::N_SIGMA:
+            ASKAPCHECK(options.cutoffValue > 0.0, "Cutoff value must be positive");
+            break;
+        default:
+            break;
+    }
+
     const Int freqAxis = CoordinateUtil::findSpectralAxis(coords);
     ASKAPCHECK(freqAxis >= 0, "Image must have a frequency axis");
     const uInt nFreqs = static_cast<uInt>(imageShape(freqAxis));
-    Vector<MVFrequency> freqValues(nFreqs);
+    const SliceLayout layout(latAxis, longAxis, freqAxis, polAxis, nStokes);
+
+    // With a restoring beam per channel, each run of channels with the same
+    // beam is projected separately, with that beam
+    const bool restoring = !options.restoringBeams.empty();
+    if (options.restoringBeams.size() > 1) {
+        ASKAPCHECK(options.restoringBeams.size() == nFreqs,
+                   "There must be one restoring beam, or one per channel");
+        ASKAPCHECK(!sparse, "A sparse model only supports a single restoring beam");
+        ProjectionOptions runOptions = options;
+        for (uInt runStart = 0; runStart < nFreqs; ) {
+            uInt runEnd = runStart + 1;
+            while (runEnd < nFreqs &&
+                    options.restoringBeams[runEnd] == options.restoringBeams[runStart]) {
+                ++runEnd;
+            }
+            runOptions.restoringBeams.assign(1, options.restoringBeams[runStart]);
+
+            IPosition blc(imageShape.nelements(), 0);
+            IPosition length = imageShape;
+            blc(freqAxis) = runStart;
+            length(freqAxis) = runEnd - runStart;
+            std::vector<SubImage<T> > runImages;
+            runImages.reserve(nTerms);
+            std::vector<casacore::ImageInterface<T>*> runPointers(nTerms);
+            for (size_t t = 0; t < nTerms; ++t) {
+                runImages.push_back(SubImage<T>(*images[t], Slicer(blc, length), True));
+                runPointers[t] = &runImages.back();
+            }
+            projectTerms(runPointers, 0, terms, components, runOptions);
+            runStart = runEnd;
+        }
+        return;
+    }
+
+    // Get the frequency axis and get the log of all the frequencies, from
+    // which the spectral scale of each component is calculated
+    std::vector<double> logFreqs(nFreqs);
     {
         SpectralCoordinate specCoord =
             coords.spectralCoordinate(coords.findCoordinate(Coordinate::SPECTRAL));
@@ -149,253 +1151,946 @@ void AskapComponentImager::project(casacore::ImageInterface<T>& image,
             if (!specCoord.toWorld(thisFreq, static_cast<Double>(f))) {
                 ASKAPTHROW(AskapError, "Cannot convert a frequency value");
             }
-            freqValues(f) = MVFrequency(thisFreq);
+            logFreqs[f] = log(thisFreq);
         }
     }
 
-    // Process each SkyComponent individually
-    for (uInt i = 0; i < list.nelements(); ++i) {
-        const SkyComponent& c = list.component(i);
+    // The components are processed in blocks. For each block:
+    // 1) The flux in each plane, the pixel position and the extent of each
+    //    component are determined. This uses the casacore measures and
+    //    coordinates classes, which are not thread safe, so is done serially.
+    //    The block is divided into batches of a single spectral kind, and
+    //    then of a single shape, and each batch is handled by a kernel
+    //    specialised for it.
+    // 2) The footprint of each gaussian and disk is evaluated, in parallel,
+    //    with the gaussian integration kernel chosen once for the whole batch.
+    // 3) The channels (of each taylor term image) are divided amongst the
+    //    threads and the footprints added to the images. Each channel is only
+    //    written by one thread, and the components are always added in list
+    //    order, so the result does not depend on the number of threads or
+    //    on the batching.
+    // In the streaming mode this is done for each block of channels in turn,
+    // with the footprints added to an in-memory copy of the channel block.
+    const unsigned int nThreads = (options.nThreads > 0) ? options.nThreads
+                                  : std::max(1u, std::thread::hardware_concurrency());
+    Vector<Double> pixelPosition(2);
+    std::mutex ioMutex;
+
+    // The components which may contribute to the image, in list order
+    std::vector<uInt> candidates;
+    if (options.componentIndex) {
+        ASKAPCHECK(options.componentIndex->nelements() == components.nelements(),
+                   "Component index does not match the component list");
+        options.componentIndex->query(dirCoord, imageShape(latAxis), imageShape(longAxis),
+                                      cullingSigmas(options), candidates);
+    } else {
+        candidates.resize(components.nelements());
+        for (uInt i = 0; i < components.nelements(); ++i) {
+            candidates[i] = i;
+        }
+    }
+    if (stats && candidates.size() < components.nelements()) {
+        // Count the components excluded by the index. The candidates are in
+        // list order.
+        size_t n = 0;
+        for (uInt i = 0; i < components.nelements(); ++i) {
+            if (n < candidates.size() && candidates[n] == i) {
+                ++n;
+                continue;
+            }
+            const ProjectionStats::Shape shape = statsShape(components.shape(i));
+            if (shape != ProjectionStats::N_SHAPES) {
+                ++stats->culled[shape];
+            }
+        }
+    }
+    if (candidates.empty()) {
+        return;
+    }
+
+    // Pixel positions of the candidates, if they are cached. Only the
+    // candidates are converted, so components culled by the index (which
+    // may not even have a pixel position) cost nothing.
+    const std::vector<double>* cachedPositions = 0;
+    if (options.positionCache) {
+        PhaseTimer timer(stats ? &stats->coordinateSeconds : 0);
+        cachedPositions = &options.positionCache->positions(*components.list(), dirCoord,
+                          candidates);
+    }
+
+    // The flux and spectral parameters of every candidate, so the flux in
+    // each plane is the product of a per channel and a per polarisation factor.
+    // Row n of the table is component candidates[n] of the list.
+    PhaseTimer fluxTimer(stats ? &stats->fluxSeconds : 0);
+    const ComponentFluxTable fluxTable = components.fluxTable(candidates, options);
+    fluxTimer.stop();
+
+    // The block of prepared components, and its batches. The spectral batches
+    // hold rows of the flux table, and the shape batches hold indices into
+    // the block.
+    std::vector<PreparedComponent<T> > block;
+    std::vector<size_t> spectralBatches[ComponentFluxTable::CURVED + 1];
+    std::vector<size_t> points;
+    std::vector<size_t> gaussians;
+    std::vector<size_t> disks;
+    std::vector<size_t> prepared;
+
+    // With a footprint cache, every gaussian of the block on the image, its
+    // key, and the block index of the component whose footprint it shares
+    // (its own if it is integrated, or NO_SOURCE if taken from the cache)
+    const size_t NO_SOURCE = std::numeric_limits<size_t>::max();
+    std::vector<size_t> cacheGaussians;
+    std::vector<FootprintCache::Key> cacheKeys;
+    std::vector<size_t> cacheSources;
+    std::vector<int> cacheOrigins;
+    std::map<FootprintCache::Key, size_t> blockMisses;
+
+    // Scratch space for each worker thread, which is kept for the whole
+    // projection so it is only allocated when it needs to grow
+    std::vector<GaussianRowEvaluator> evaluators(nThreads);
+    std::vector<Array<T> > sliceBuffers(nThreads);
+
+    // The estimated cost of each footprint of a batch, and the tasks they
+    // are evaluated in
+    std::vector<FootprintCost> footprintCosts;
+    std::vector<FootprintTask> footprintTasks;
+
+    // For the streaming mode, the largest absolute flux over all planes and
+    // the pixel position of each candidate, which are found before any
+    // channel block is rendered. The positions are indexed (2n, 2n + 1).
+    std::vector<double> maxFluxes;
+    std::vector<double> positions;
+
+    // Find the pixel position of candidate n
+    auto findPixelPosition = [&](const size_t n) {
+        const uInt i = candidates[n];
+        if (cachedPositions) {
+            pixelPosition(0) = (*cachedPositions)[2 * n];
+            pixelPosition(1) = (*cachedPositions)[2 * n + 1];
+        } else if (!positions.empty()) {
+            pixelPosition(0) = positions[2 * n];
+            pixelPosition(1) = positions[2 * n + 1];
+        } else {
+            const bool toPixelOk = components.toPixel(dirCoord, i, pixelPosition);
+            ASKAPCHECK(toPixelOk, "toPixel failed");
+        }
+    };
+
+    // Scale flux based on spectral model and taylor term, for the candidates
+    // [blockStart, blockEnd) and the given channels. This is the only thing
+    // which differs between the image planes, so the footprint of a component
+    // is calculated once and then scaled for each plane.
+    auto fillBlockFlux = [&](const size_t blockStart, const size_t blockEnd,
+                             const std::vector<double>& blockLogFreqs) {
+        PhaseTimer timer(stats ? &stats->fluxSeconds : 0);
+        for (size_t kind = 0; kind <= ComponentFluxTable::CURVED; ++kind) {
+            spectralBatches[kind].clear();
+        }
+        for (size_t n = blockStart; n < blockEnd; ++n) {
+            spectralBatches[fluxTable.spectralKind(n)].push_back(n);
+        }
+        fillFlux<FlatScale>(fluxTable, spectralBatches[ComponentFluxTable::FLAT],
+                            blockStart, blockLogFreqs, terms, stokes, block);
+        fillFlux<PowerLawScale>(fluxTable, spectralBatches[ComponentFluxTable::POWER_LAW],
+                                blockStart, blockLogFreqs, terms, stokes, block);
+        fillFlux<CurvedScale>(fluxTable, spectralBatches[ComponentFluxTable::CURVED],
+                              blockStart, blockLogFreqs, terms, stokes, block);
+    };
+
+    // Prepare the candidates [blockStart, blockEnd) for the given channels,
+    // leaving the block indices of those on the image in prepared. The
+    // footprint is sized for the brightest plane of any term and channel.
+    // In the streaming mode the same components are prepared for each
+    // channel block, so they are only counted in the statistics once.
+    bool countComponents = true;
+    auto prepareBlock = [&](const size_t blockStart, const size_t blockEnd,
+                            const std::vector<double>& blockLogFreqs) {
+        const size_t blockLength = blockEnd - blockStart;
+        fillBlockFlux(blockStart, blockEnd, blockLogFreqs);
+        if (!maxFluxes.empty()) {
+            for (size_t k = 0; k < blockLength; ++k) {
+                block[k].maxFlux = maxFluxes[blockStart + k];
+            }
+        }
+
+        PhaseTimer coordinateTimer(stats ? &stats->coordinateSeconds : 0);
+        points.clear();
+        gaussians.clear();
+        disks.clear();
+        for (size_t k = 0; k < blockLength; ++k) {
+            PreparedComponent<T>& pc = block[k];
+            pc.shape = components.shape(candidates[blockStart + k]);
+            pc.onImage = false;
+            pc.evaluated = 0;
+            switch (pc.shape) {
+                case ComponentType::POINT:
+                    // A restored point is rendered as the beam
+                    if (restoring) {
+                        gaussians.push_back(k);
+                    } else {
+                        points.push_back(k);
+                    }
+                    break;
+
+                case ComponentType::GAUSSIAN:
+                    gaussians.push_back(k);
+                    break;
+
+                case ComponentType::DISK:
+                    ASKAPCHECK(!restoring,
+                               "Disk components cannot be convolved with a restoring beam");
+                    disks.push_back(k);
+                    break;
+
+                default:
+                    ASKAPTHROW(AskapError, "Unsupported shape type");
+                    break;
+            }
+        }
 
-        for (uInt freqIdx = 0; freqIdx < nFreqs; ++freqIdx) {
+        for (size_t p = 0; p < points.size(); ++p) {
+            PreparedComponent<T>& pc = block[points[p]];
+            findPixelPosition(blockStart + points[p]);
+            pc.onImage = makePointFootprint(pixelPosition, imageShape,
+                                            latAxis, longAxis, pc.footprint);
+        }
 
-            // Scale flux based on spectral model and taylor term
-            const MFrequency chanFrequency(freqValues(freqIdx).get());
-            Flux<Double> flux = makeFlux(c, chanFrequency, term);
+        // Only the gaussians on the image are kept in their batch
+        size_t nGaussians = 0;
+        for (size_t g = 0; g < gaussians.size(); ++g) {
+            PreparedComponent<T>& pc = block[gaussians[g]];
+            if (pc.maxFlux > 0.0) {
+                findPixelPosition(blockStart + gaussians[g]);
+                double majorAxis = 0.0;
+                double minorAxis = 0.0;
+                double pa = 0.0;
+                if (pc.shape == ComponentType::GAUSSIAN) {
+                    components.axes(candidates[blockStart + gaussians[g]],
+                                    majorAxis, minorAxis, pa);
+                }
+                pc.onImage = makeGaussian<T>(pc.shape, majorAxis, minorAxis, pa,
+                                             pixelPosition, imageShape,
+                                             latAxis, longAxis, dirCoord,
+                                             pc.maxFlux, options, pc.gauss, pc.footprint);
+            }
+            if (pc.onImage) {
+                gaussians[nGaussians++] = gaussians[g];
+            }
+        }
+        gaussians.resize(nGaussians);
+
+        // Likewise only the disks on the image are kept
+        size_t nDisks = 0;
+        for (size_t d = 0; d < disks.size(); ++d) {
+            PreparedComponent<T>& pc = block[disks[d]];
+            if (pc.maxFlux > 0.0) {
+                findPixelPosition(blockStart + disks[d]);
+                double majorAxis, minorAxis, pa;
+                components.axes(candidates[blockStart + disks[d]], majorAxis, minorAxis, pa);
+                pc.onImage = makeDisk(majorAxis, minorAxis, pa, pixelPosition, imageShape,
+                                      latAxis, longAxis, dirCoord, pc.disk, pc.footprint);
+            }
+            if (pc.onImage) {
+                disks[nDisks++] = disks[d];
+            }
+        }
+        disks.resize(nDisks);
+        coordinateTimer.stop();
+
+        PhaseTimer kernelTimer(stats ? &stats->kernelSeconds : 0);
+
+        // With a footprint cache, only the gaussians whose footprint is
+        // neither cached nor shared with an earlier gaussian of the block are
+        // integrated. These are integrated relative to the pixel below their
+        // centre, so the footprint can be cached, and then moved back.
+        if (options.footprintCache) {
+            FootprintCache& cache = *options.footprintCache;
+            cacheGaussians = gaussians;
+            cacheKeys.resize(gaussians.size());
+            cacheSources.resize(gaussians.size());
+            cacheOrigins.resize(2 * gaussians.size());
+            blockMisses.clear();
+            gaussians.clear();
+            for (size_t g = 0; g < cacheGaussians.size(); ++g) {
+                const size_t k = cacheGaussians[g];
+                PreparedComponent<T>& pc = block[k];
+                const int originLat = static_cast<int>(floor(pc.gauss.xCenter()));
+                const int originLon = static_cast<int>(floor(pc.gauss.yCenter()));
+                FootprintCache::Key& key = cacheKeys[g];
+                key.major = pc.gauss.majorAxis();
+                key.minor = pc.gauss.minorAxis();
+                key.pa = pc.gauss.PA();
+                key.flux = pc.gauss.flux();
+                key.xOffset = cache.quantise(pc.gauss.xCenter() - originLat);
+                key.yOffset = cache.quantise(pc.gauss.yCenter() - originLon);
+                key.startLat = pc.footprint.startLat() - originLat;
+                key.startLon = pc.footprint.startLon() - originLon;
+                key.nLat = pc.footprint.nLat();
+                key.nLon = pc.footprint.nLon();
+                key.kernel = options.gaussianKernel;
+                key.precision = sizeof(T);
+                cacheOrigins[2 * g] = originLat;
+                cacheOrigins[2 * g + 1] = originLon;
+                pc.gauss.setXcenter(originLat + key.xOffset);
+                pc.gauss.setYcenter(originLon + key.yOffset);
+
+                const ComponentFootprint* cached = cache.find(key);
+                if (cached) {
+                    std::copy(cached->data(),
+                              cached->data() + static_cast<size_t>(key.nLat) * key.nLon,
+                              pc.footprint.data());
+                    cacheSources[g] = NO_SOURCE;
+                    continue;
+                }
+                const std::map<FootprintCache::Key, size_t>::const_iterator it =
+                    blockMisses.find(key);
+                if (it != blockMisses.end()) {
+                    cacheSources[g] = it->second;
+                    continue;
+                }
+                blockMisses[key] = k;
+                cacheSources[g] = k;
+                pc.gauss.setXcenter(key.xOffset);
+                pc.gauss.setYcenter(key.yOffset);
+                pc.footprint.move(key.startLat, key.startLon);
+                gaussians.push_back(k);
+            }
+            if (stats) {
+                stats->footprintCacheHits += cacheGaussians.size() - gaussians.size();
+                stats->footprintCacheMisses += gaussians.size();
+            }
+        }
 
-            for (uInt polIdx = 0; polIdx < stokes.size(); ++polIdx) {
+        // The footprints are evaluated as tasks of similar cost, with large
+        // footprints split into bands of rows. A split footprint has every
+        // pixel evaluated, which is counted before its bands are evaluated
+        // concurrently.
+        footprintCosts.resize(disks.size());
+        for (size_t d = 0; d < disks.size(); ++d) {
+            PreparedComponent<T>& pc = block[disks[d]];
+            FootprintCost& cost = footprintCosts[d];
+            cost.pixels = static_cast<size_t>(pc.footprint.nLat()) * pc.footprint.nLon();
+            cost.nRows = pc.footprint.nLon();
+            cost.splittable = true;
+            pc.evaluated = cost.pixels;
+        }
+        makeFootprintTasks(footprintCosts, nThreads, footprintTasks);
+        parallelFor(nThreads, footprintTasks.size(), [&](size_t t) {
+            const FootprintTask& task = footprintTasks[t];
+            for (size_t d = task.begin; d < task.end; ++d) {
+                PreparedComponent<T>& pc = block[disks[d]];
+                evaluateDiskFootprint(pc.disk, pc.footprint,
+                                      task.endRow ? task.firstRow : 0,
+                                      task.endRow ? task.endRow : pc.footprint.nLon());
+            }
+        });
+
+        // A line gaussian crosses about as many pixels as the longer side of
+        // its footprint, and is always evaluated whole
+        footprintCosts.resize(gaussians.size());
+        for (size_t g = 0; g < gaussians.size(); ++g) {
+            PreparedComponent<T>& pc = block[gaussians[g]];
+            FootprintCost& cost = footprintCosts[g];
+            const bool line = pc.gauss.minorAxis() < 1.e-3;
+            cost.pixels = line ? std::max(pc.footprint.nLat(), pc.footprint.nLon())
+                          : static_cast<size_t>(pc.footprint.nLat()) * pc.footprint.nLon();
+            cost.nRows = pc.footprint.nLon();
+            cost.splittable = !line;
+            pc.evaluated = cost.pixels;
+        }
+        makeFootprintTasks(footprintCosts, nThreads, footprintTasks);
+
+        // The kernel is chosen once for the batch
+        size_t (*evaluate)(const Gaussian2D<T>&, GaussianRowEvaluator&,
+                           ComponentFootprint&, const uInt, const uInt) =
+            &AskapComponentImager::evaluateFootprint<T, ProjectionOptions::SIMPSON>;
+        if (options.gaussianKernel == ProjectionOptions::ANALYTIC) {
+            evaluate = &AskapComponentImager::evaluateFootprint<T, ProjectionOptions::ANALYTIC>;
+        } else if (options.gaussianKernel == ProjectionOptions::SIMPSON_SINGLE) {
+            evaluate = &AskapComponentImager::evaluateFootprint<T, ProjectionOptions::SIMPSON_SINGLE>;
+        }
+        parallelForSlots(nThreads, footprintTasks.size(), [&](size_t t, unsigned int slot) {
+            const FootprintTask& task = footprintTasks[t];
+            for (size_t g = task.begin; g < task.end; ++g) {
+                PreparedComponent<T>& pc = block[gaussians[g]];
+                if (task.endRow) {
+                    evaluate(pc.gauss, evaluators[slot], pc.footprint,
+                             task.firstRow, task.endRow);
+                } else {
+                    pc.evaluated = evaluate(pc.gauss, evaluators[slot], pc.footprint,
+                                            0, pc.footprint.nLon());
+                }
+            }
+        });
+
+        if (options.footprintCache) {
+            // Cache the integrated footprints and move them back into place,
+            // then copy them for the gaussians which share them
+            for (size_t g = 0; g < cacheGaussians.size(); ++g) {
+                PreparedComponent<T>& pc = block[cacheGaussians[g]];
+                if (cacheSources[g] != cacheGaussians[g]) {
+                    continue;
+                }
+                const FootprintCache::Key& key = cacheKeys[g];
+                options.footprintCache->insert(key, pc.footprint);
+                pc.footprint.move(cacheOrigins[2 * g] + key.startLat,
+                                  cacheOrigins[2 * g + 1] + key.startLon);
+                pc.gauss.setXcenter(cacheOrigins[2 * g] + key.xOffset);
+                pc.gauss.setYcenter(cacheOrigins[2 * g + 1] + key.yOffset);
+            }
+            for (size_t g = 0; g < cacheGaussians.size(); ++g) {
+                const size_t source = cacheSources[g];
+                if (source == NO_SOURCE || source == cacheGaussians[g]) {
+                    continue;
+                }
+                PreparedComponent<T>& pc = block[cacheGaussians[g]];
+                const ComponentFootprint& footprint = block[source].footprint;
+                std::copy(footprint.data(),
+                          footprint.data() + static_cast<size_t>(footprint.nLat()) * footprint.nLon(),
+                          pc.footprint.data());
+            }
+        }
+        kernelTimer.stop();
 
-                switch (c.shape().type()) {
-                    case ComponentType::POINT:
-                        projectPointShape(image, c, latAxis, longAxis, dirCoord,
-                                          freqAxis, freqIdx, flux,
-                                          polAxis, polIdx, stokes(polIdx));
-                        break;
+        // The components on the image, in list order
+        prepared.clear();
+        for (size_t k = 0; k < blockLength; ++k) {
+            if (block[k].onImage) {
+                prepared.push_back(k);
+            }
+        }
 
-                    case ComponentType::GAUSSIAN:
-                        projectGaussianShape(image, c, latAxis, longAxis, dirCoord,
-                                             freqAxis, freqIdx, flux,
-                                             polAxis, polIdx, stokes(polIdx));
-                        break;
+        if (stats) {
+            for (size_t k = 0; k < blockLength; ++k) {
+                const PreparedComponent<T>& pc = block[k];
+                const ProjectionStats::Shape shape = statsShape(pc.shape);
+                const bool gaussian = shape == ProjectionStats::GAUSSIAN
+                                      || (restoring && shape == ProjectionStats::POINT);
+                if (pc.onImage && gaussian) {
+                    const bool line = pc.gauss.minorAxis() < 1.e-3;
+                    stats->pixelsEvaluated[line ? ProjectionStats::LINE_GAUSSIAN
+                                           : ProjectionStats::GAUSSIAN_2D] += pc.evaluated;
+                } else if (pc.onImage && shape == ProjectionStats::DISK) {
+                    stats->pixelsEvaluated[ProjectionStats::DISK_OVERLAP] += pc.evaluated;
+                }
+                if (!countComponents) {
+                    continue;
+                }
+                if (pc.onImage) {
+                    ++stats->rendered[shape];
+                    stats->footprintPixels[shape] +=
+                        static_cast<size_t>(pc.footprint.nLat()) * pc.footprint.nLon();
+                } else {
+                    ++stats->culled[shape];
+                }
+            }
+        }
+    };
+
+    // @return true if any polarisation of a plane has a non-zero flux
+    auto hasFlux = [nStokes](const double* flux) {
+        return std::find_if(flux, flux + nStokes,
+                            [](double f) { return f != 0.0; }) != flux + nStokes;
+    };
+
+    if (sparse) {
+        block.resize(std::min(candidates.size(), std::max(static_cast<size_t>(1),
+                              BLOCK_FLUX_MEMORY / (nFreqs * nStokes * sizeof(double)))));
+        for (size_t blockStart = 0; blockStart < candidates.size(); blockStart += block.size()) {
+            const size_t blockEnd = std::min(candidates.size(), blockStart + block.size());
+            prepareBlock(blockStart, blockEnd, logFreqs);
+
+            // Each channel (with all of its polarisations) is only written
+            // by one thread
+            PhaseTimer imageTimer(stats ? &stats->imageSeconds : 0);
+            parallelFor(nThreads, nFreqs, [&](size_t freqIdx) {
+                for (size_t p = 0; p < prepared.size(); ++p) {
+                    const PreparedComponent<T>& pc = block[prepared[p]];
+                    addSparseFootprint(*sparse, pc.footprint, freqIdx,
+                                       &pc.flux[freqIdx * nStokes], nStokes);
+                }
+            });
+        }
+        PhaseTimer imageTimer(stats ? &stats->imageSeconds : 0);
+        sparse->compact();
+        return;
+    }
 
-                    default:
-                        ASKAPTHROW(AskapError, "Unsupported shape type");
-                        break;
+    if (options.channelBlockMemory == 0 && !options.compensatedSummation
+            && options.writeQueueDepth == 0) {
+        block.resize(std::min(candidates.size(), std::max(static_cast<size_t>(1),
+                              BLOCK_FLUX_MEMORY / (nTerms * nFreqs * nStokes * sizeof(double)))));
+        for (size_t blockStart = 0; blockStart < candidates.size(); blockStart += block.size()) {
+            const size_t blockEnd = std::min(candidates.size(), blockStart + block.size());
+            prepareBlock(blockStart, blockEnd, logFreqs);
+
+            // Planes are numbered (termIdx * nFreqs + freqIdx)
+            PhaseTimer imageTimer(stats ? &stats->imageSeconds : 0);
+            parallelForSlots(nThreads, nTerms * nFreqs, [&](size_t plane, unsigned int slot) {
+                casacore::ImageInterface<T>& image = *images[plane / nFreqs];
+                const uInt freqIdx = plane % nFreqs;
+                Array<T>& buffer = sliceBuffers[slot];
+                for (size_t p = 0; p < prepared.size(); ++p) {
+                    const PreparedComponent<T>& pc = block[prepared[p]];
+                    const double* flux = &pc.flux[plane * nStokes];
+                    if (hasFlux(flux)) {
+                        addFootprint(image, pc.footprint, layout, freqIdx, flux,
+                                     buffer, ioMutex);
+                    }
                 }
+            });
+        } // End component list loop
+        return;
+    }
+
+    // Streaming mode. Find the brightest plane and the pixel position of
+    // each candidate, so the footprints are identical to those above
+    block.resize(std::min(candidates.size(), std::max(static_cast<size_t>(1),
+                          BLOCK_FLUX_MEMORY / (nTerms * nFreqs * nStokes * sizeof(double)))));
+    maxFluxes.resize(candidates.size());
+    for (size_t blockStart = 0; blockStart < candidates.size(); blockStart += block.size()) {
+        const size_t blockEnd = std::min(candidates.size(), blockStart + block.size());
+        fillBlockFlux(blockStart, blockEnd, logFreqs);
+        for (size_t n = blockStart; n < blockEnd; ++n) {
+            maxFluxes[n] = block[n - blockStart].maxFlux;
+        }
+    }
+    if (!cachedPositions) {
+        PhaseTimer timer(stats ? &stats->coordinateSeconds : 0);
+        std::vector<double> candidatePositions(2 * candidates.size());
+        for (size_t n = 0; n < candidates.size(); ++n) {
+            // As above, the position of a zero flux gaussian or disk isn't needed
+            if (maxFluxes[n] > 0.0 ||
+                    components.shape(candidates[n]) == ComponentType::POINT) {
+                findPixelPosition(n);
+                candidatePositions[2 * n] = pixelPosition(0);
+                candidatePositions[2 * n + 1] = pixelPosition(1);
+            }
+        }
+        positions.swap(candidatePositions);
+    }
+
+    // The channel block is the largest multiple of the image's preferred
+    // cursor shape (a whole number of tiles for a paged image) along the
+    // frequency axis which fits the memory budget, or fewer channels if even
+    // one cursor does not fit. The budget holds the buffers of the block being
+    // rendered and of each block queued for writing, and with compensated
+    // summation the compensation terms too. It defaults to a cursor per thread.
+    const bool compensated = options.compensatedSummation;
+    const size_t nBufferSets = options.writeQueueDepth + 1;
+    const uInt nLat = imageShape(latAxis);
+    const uInt nLon = imageShape(longAxis);
+    const size_t channelBytes = static_cast<size_t>(nLat) * nLon * nStokes * sizeof(T) * nTerms
+                                * (nBufferSets + (compensated ? 1 : 0));
+    const size_t tileChannels = std::max(1, static_cast<int>(images[0]->niceCursorShape()(freqAxis)));
+    const size_t blockMemory = (options.channelBlockMemory > 0) ? options.channelBlockMemory
+                               : nThreads * tileChannels * channelBytes;
+    size_t blockChannels = std::max(static_cast<size_t>(1), blockMemory / channelBytes);
+    if (blockChannels >= tileChannels) {
+        blockChannels -= blockChannels % tileChannels;
+    }
+    blockChannels = std::min(blockChannels, static_cast<size_t>(nFreqs));
+    const size_t nChanBlocks = (nFreqs + blockChannels - 1) / blockChannels;
+
+    // Channel block b uses buffer set (b % nBufferSets). With a write queue,
+    // the image I/O is done by a separate thread for each buffer set, which
+    // writes the block just rendered and then reads the next block to use
+    // the set. Only one of them accesses the images at a time. Rendering a
+    // block waits for its read, which follows the write of the block that
+    // last used the set, so at most writeQueueDepth blocks are queued.
+    std::vector<ChannelBlock<T> > chanBlocks(std::min(nBufferSets, nChanBlocks));
+    auto readBlock = [&](const size_t b, ChannelBlock<T>& chanBlock) {
+        const uInt chanStart = b * blockChannels;
+        const uInt nChans = std::min(blockChannels, static_cast<size_t>(nFreqs - chanStart));
+        readChannelBlock(images, layout, nLat, nLon, chanStart, nChans, chanBlock);
+    };
+    const bool queued = chanBlocks.size() > 1;
+    std::vector<std::future<void> > pendingIO(queued ? chanBlocks.size() : 0);
+    for (size_t set = 0; set < pendingIO.size(); ++set) {
+        pendingIO[set] = std::async(std::launch::async, [&, set]() {
+            std::lock_guard<std::mutex> lock(ioMutex);
+            readBlock(set, chanBlocks[set]);
+        });
+    }
 
-            } // end polIdx loop
-        } // End freqIdx loop
+    std::vector<std::vector<T> > compensation(compensated ? nTerms : 0);
+    for (size_t b = 0; b < nChanBlocks; ++b) {
+        const size_t set = b % chanBlocks.size();
+        ChannelBlock<T>& chanBlock = chanBlocks[set];
+
+        // Read the channel block of each image once
+        PhaseTimer readTimer(stats ? &stats->imageSeconds : 0);
+        if (queued) {
+            pendingIO[set].get();
+        } else {
+            readBlock(b, chanBlock);
+        }
+        readTimer.stop();
+
+        const uInt chanStart = chanBlock.chanStart;
+        const uInt nChans = chanBlock.nChans;
+        const std::vector<T*>& bufferData = chanBlock.data;
+        const std::vector<double> blockLogFreqs(logFreqs.begin() + chanStart,
+                                                logFreqs.begin() + chanStart + nChans);
+        const size_t blockElements = static_cast<size_t>(nLat) * nLon * nStokes * nChans;
+        for (size_t termIdx = 0; termIdx < compensation.size(); ++termIdx) {
+            compensation[termIdx].assign(blockElements, T(0));
+        }
 
-    } // End component list loop
+        // Offsets between adjacent elements of the block along each axis
+        ssize_t latStride, lonStride, freqStride, polStride;
+        layout.strides(nLat, nLon, nChans, latStride, lonStride, freqStride, polStride);
+
+        block.resize(std::min(candidates.size(), std::max(static_cast<size_t>(1),
+                              BLOCK_FLUX_MEMORY / (nTerms * nChans * nStokes * sizeof(double)))));
+        for (size_t blockStart = 0; blockStart < candidates.size(); blockStart += block.size()) {
+            const size_t blockEnd = std::min(candidates.size(), blockStart + block.size());
+            prepareBlock(blockStart, blockEnd, blockLogFreqs);
+
+            // Planes of the block are numbered (termIdx * nChans + chan)
+            PhaseTimer imageTimer(stats ? &stats->imageSeconds : 0);
+            parallelFor(nThreads, nTerms * nChans, [&](size_t plane) {
+                const ssize_t planeOffset = (plane % nChans) * freqStride;
+                T* planeData = bufferData[plane / nChans] + planeOffset;
+                T* planeCompensation = compensated
+                                       ? &compensation[plane / nChans][0] + planeOffset : 0;
+                for (size_t p = 0; p < prepared.size(); ++p) {
+                    const PreparedComponent<T>& pc = block[prepared[p]];
+                    const double* flux = &pc.flux[plane * nStokes];
+                    if (hasFlux(flux)) {
+                        const ComponentFootprint& footprint = pc.footprint;
+                        const ssize_t offset = footprint.startLat() * latStride
+                                               + footprint.startLon() * lonStride;
+                        if (compensated) {
+                            accumulateFootprintCompensated(footprint, flux, nStokes,
+                                                           planeData + offset,
+                                                           planeCompensation + offset,
+                                                           latStride, lonStride, polStride);
+                        } else {
+                            accumulateFootprint(footprint, flux, nStokes, planeData + offset,
+                                                latStride, lonStride, polStride);
+                        }
+                    }
+                }
+            });
+        }
+
+        // Apply the remaining compensation, so each element is the
+        // compensated sum rounded once
+        if (compensated) {
+            for (size_t termIdx = 0; termIdx < nTerms; ++termIdx) {
+                T* data = bufferData[termIdx];
+                const T* comp = &compensation[termIdx][0];
+                const size_t n = compensation[termIdx].size();
+                for (size_t i = 0; i < n; ++i) {
+                    data[i] = static_cast<T>(data[i] - static_cast<double>(comp[i]));
+                }
+            }
+        }
+
+        countComponents = false;
+
+        // Write the channel block of each image once
+        if (queued) {
+            pendingIO[set] = std::async(std::launch::async, [&, set, b]() {
+                std::lock_guard<std::mutex> lock(ioMutex);
+                writeChannelBlock(images, layout, chanBlocks[set]);
+                if (b + nBufferSets < nChanBlocks) {
+                    readBlock(b + nBufferSets, chanBlocks[set]);
+                }
+            });
+        } else {
+            PhaseTimer writeTimer(stats ? &stats->imageSeconds : 0);
+            writeChannelBlock(images, layout, chanBlock);
+        }
+    }
+
+    // Wait for the queued writes
+    PhaseTimer writeTimer(stats ? &stats->imageSeconds : 0);
+    for (size_t set = 0; set < pendingIO.size(); ++set) {
+        pendingIO[set].get();
+    }
 }
 
-template <class T>
-void AskapComponentImager::projectPointShape(casacore::ImageInterface<T>& image,
-        const casacore::SkyComponent& c,
+bool AskapComponentImager::makePointFootprint(const casacore::Vector<casacore::Double>& pixelPosition,
+        const casacore::IPosition& imageShape,
         const casacore::Int latAxis, const casacore::Int longAxis,
-        const casacore::DirectionCoordinate& dirCoord,
-        const casacore::Int freqAxis, const casacore::uInt freqIdx,
-        const casacore::Flux<casacore::Double>& flux,
-        const casacore::Int polAxis, const casacore::uInt polIdx,
-        const casacore::Stokes::StokesTypes& stokes)
+        ComponentFootprint& footprint)
 {
-    // Convert world position to pixel position
-    const MDirection& dir = c.shape().refDirection();
-    Vector<Double> pixelPosition(2);
-    const bool toPixelOk = dirCoord.toPixel(pixelPosition, dir);
-    ASKAPCHECK(toPixelOk, "toPixel failed");
-
     // Don't image this component if it falls outside the image
-    const IPosition imageShape = image.shape();
     const double latPosition = round(pixelPosition(0));
     const double lonPosition = round(pixelPosition(1));
     if (latPosition < 0 || latPosition > (imageShape(latAxis) - 1)
             || lonPosition < 0 || lonPosition > (imageShape(longAxis) - 1)) {
-        return;
+        return false;
     }
 
-    // Add to image
-    const IPosition pos = makePosition(latAxis, longAxis, freqAxis, polAxis,
-                                       static_cast<size_t>(latPosition),
-                                       static_cast<size_t>(lonPosition),
-                                       freqIdx, polIdx);
-    image.putAt(image(pos) + (flux.copy().value(stokes, true).getValue("Jy")), pos);
+    // All of the flux goes in the one pixel
+    const int lat = static_cast<int>(latPosition);
+    const int lon = static_cast<int>(lonPosition);
+    footprint.resize(lat, lat, lon, lon);
+    footprint(0, 0) = 1.0;
+    return true;
 }
 
 template <class T>
-void AskapComponentImager::projectGaussianShape(casacore::ImageInterface<T>& image,
-        const casacore::SkyComponent& c,
+bool AskapComponentImager::makeGaussian(const casacore::ComponentType::Shape shape,
+        const double majorAxis, const double minorAxis, const double pa,
+        const casacore::Vector<casacore::Double>& pixelPosition,
+        const casacore::IPosition& imageShape,
         const casacore::Int latAxis, const casacore::Int longAxis,
         const casacore::DirectionCoordinate& dirCoord,
-        const casacore::Int freqAxis, const casacore::uInt freqIdx,
-        const casacore::Flux<casacore::Double>& flux,
-        const casacore::Int polAxis, const casacore::uInt polIdx,
-        const casacore::Stokes::StokesTypes& stokes)
+        const double maxFlux,
+        const ProjectionOptions& options,
+        casacore::Gaussian2D<T>& gauss,
+        ComponentFootprint& footprint)
 {
-    // Convert world position to pixel position
-    const MDirection& dir = c.shape().refDirection();
-    Vector<Double> pixelPosition(2);
-    const bool toPixelOk = dirCoord.toPixel(pixelPosition, dir);
-    ASKAPCHECK(toPixelOk, "toPixel failed");
-
     // Don't image this component if it falls outside the image
     // Note: This code will cull those components which may (due to rounding)
     // have been positioned in the edge pixels.
-    const IPosition imageShape = image.shape();
     if (pixelPosition(0) < 0 || pixelPosition(0) > (imageShape(latAxis) - 1)
             || pixelPosition(1) < 0 || pixelPosition(1) > (imageShape(longAxis) - 1)) {
-        return;
+        return false;
     }
 
-    // Get the pixel sizes then convert the axis sizes to pixels
-    const GaussianShape& cShape = dynamic_cast<const GaussianShape&>(c.shape());
+    // Get the pixel sizes then convert the axis sizes to pixels. A point
+    // has no extent of its own, so is just the restoring beam.
     const MVAngle pixelLatSize = MVAngle(abs(dirCoord.increment()(0)));
     const MVAngle pixelLongSize = MVAngle(abs(dirCoord.increment()(1)));
     ASKAPCHECK(pixelLatSize == pixelLongSize, "Non-equal pixel sizes not supported");
-    const double majorAxisPixels = cShape.majorAxisInRad() / pixelLongSize.radian();
-    const double minorAxisPixels = cShape.minorAxisInRad() / pixelLongSize.radian();
+    double majorAxisPixels = 0.0;
+    double minorAxisPixels = 0.0;
+    double positionAngle = 0.0;
+    if (shape == ComponentType::GAUSSIAN) {
+        majorAxisPixels = majorAxis / pixelLongSize.radian();
+        minorAxisPixels = minorAxis / pixelLongSize.radian();
+        positionAngle = pa;
+    } else {
+        ASKAPCHECK(!options.restoringBeams.empty(), "Component must have a gaussian shape");
+    }
+
+    // The flux of the unit flux footprint. When restoring, this is the
+    // area of the beam, so a unit flux point has a peak of one.
+    double footprintFlux = 1.0;
+    if (!options.restoringBeams.empty()) {
+        const GaussianBeam& beam = options.restoringBeams[0];
+        const double beamMajor = beam.getMajor().getValue("rad") / pixelLongSize.radian();
+        const double beamMinor = beam.getMinor().getValue("rad") / pixelLongSize.radian();
+        convolveGaussians(majorAxisPixels, minorAxisPixels, positionAngle,
+                          beamMajor, beamMinor, beam.getPA().getValue("rad"));
+        footprintFlux = M_PI * beamMajor * beamMinor / (4. * M_LN2);
+    }
 
     // Create the guassian function
-    Gaussian2D<T> gauss;
+    gauss = Gaussian2D<T>();
     gauss.setXcenter(pixelPosition(0));
     gauss.setYcenter(pixelPosition(1));
     gauss.setMinorAxis(std::numeric_limits<T>::min());
     gauss.setMajorAxis(std::max(majorAxisPixels, minorAxisPixels));
     gauss.setMinorAxis(std::min(majorAxisPixels, minorAxisPixels));
-    gauss.setPA(cShape.positionAngleInRad());
-    gauss.setFlux(flux.copy().value(stokes, true).getValue("Jy"));
-
-    // Determine how far to sample before the flux gets too low to be meaningful
-    // We do this by going out from the centre position along both the x and y
-    // axis then choose the maximum of the two
-    const T epsilon = std::numeric_limits<T>::epsilon();
-    const int cutoff = findCutoff(gauss, std::max(imageShape(latAxis), imageShape(longAxis)), epsilon);
+    gauss.setPA(positionAngle);
 
     // Determine the starting and end pixels which need processing on both axes. Note
     // that these are "inclusive" ranges.
-    const int startLat = std::max(0, static_cast<int>(pixelPosition(0)) - cutoff);
-    const int endLat = std::min(static_cast<int>(imageShape(latAxis) - 1),
-                                static_cast<int>(pixelPosition(0)) + cutoff);
-    const int startLon = std::max(0, static_cast<int>(pixelPosition(1)) - cutoff);
-    const int endLon = std::min(static_cast<int>(imageShape(longAxis) - 1),
-                                static_cast<int>(pixelPosition(1)) + cutoff);
-
-    IPosition pos = makePosition(latAxis, longAxis, freqAxis, polAxis,
-                                 static_cast<size_t>(nearbyint(pixelPosition[0])),
-                                 static_cast<size_t>(nearbyint(pixelPosition[1])),
-                                 freqIdx, polIdx);
-
-    // For each pixel in the region bounded by the source centre + cutoff
-    for (int lat = startLat; lat <= endLat; ++lat) {
-        for (int lon = startLon; lon <= endLon; ++lon) {
-            pos(latAxis) = lat;
-            pos(longAxis) = lon;
-            image.putAt(image(pos) + evaluateGaussian(gauss, lat, lon), pos);
-        }
+    int startLat, endLat, startLon, endLon;
+    if (options.cutoffPolicy == ProjectionOptions::MACHINE_EPSILON) {
+        // Determine how far to sample before the flux gets too low to be meaningful
+        // We do this by going out from the centre position along the major axis
+        // and use that distance for both the x and y axes. The brightest image
+        // plane is used so the footprint is large enough for all planes.
+        gauss.setFlux(maxFlux * footprintFlux);
+        const T epsilon = std::numeric_limits<T>::epsilon();
+        const int cutoff = findCutoff(gauss, std::max(imageShape(latAxis), imageShape(longAxis)), epsilon);
+
+        startLat = std::max(0, static_cast<int>(pixelPosition(0)) - cutoff);
+        endLat = std::min(static_cast<int>(imageShape(latAxis) - 1),
+                          static_cast<int>(pixelPosition(0)) + cutoff);
+        startLon = std::max(0, static_cast<int>(pixelPosition(1)) - cutoff);
+        endLon = std::min(static_cast<int>(imageShape(longAxis) - 1),
+                          static_cast<int>(pixelPosition(1)) + cutoff);
+    } else {
+        // Include every pixel which overlaps the bounding box of the
+        // truncation contour. Pixel i covers [i - 0.5, i + 0.5).
+        double halfWidthX, halfWidthY;
+        findExtent(gauss, maxFlux * footprintFlux, options, halfWidthX, halfWidthY);
+        const double maxLat = imageShape(latAxis) - 1;
+        const double maxLon = imageShape(longAxis) - 1;
+        startLat = static_cast<int>(std::max(0.0, floor(pixelPosition(0) - halfWidthX + 0.5)));
+        endLat = static_cast<int>(std::min(maxLat, floor(pixelPosition(0) + halfWidthX + 0.5)));
+        startLon = static_cast<int>(std::max(0.0, floor(pixelPosition(1) - halfWidthY + 0.5)));
+        endLon = static_cast<int>(std::min(maxLon, floor(pixelPosition(1) + halfWidthY + 0.5)));
     }
+
+    // The footprint is evaluated for a unit flux component
+    gauss.setFlux(footprintFlux);
+    footprint.resize(startLat, endLat, startLon, endLon);
+    return true;
 }
 
-IPosition AskapComponentImager::makePosition(const casacore::Int latAxis, const casacore::Int longAxis,
-        const casacore::Int spectralAxis, const casacore::Int polAxis,
-        const casacore::uInt latIdx, const casacore::uInt longIdx,
-        const casacore::uInt spectralIdx, const casacore::uInt polIdx)
+bool AskapComponentImager::makeDisk(const double majorAxis, const double minorAxis,
+        const double pa,
+        const casacore::Vector<casacore::Double>& pixelPosition,
+        const casacore::IPosition& imageShape,
+        const casacore::Int latAxis, const casacore::Int longAxis,
+        const casacore::DirectionCoordinate& dirCoord,
+        DiskEvaluator& disk,
+        ComponentFootprint& footprint)
 {
-    // Count the number of valid axes
-    uInt naxis = 0;
-
-    if (latAxis >= 0) ++naxis;
-    if (longAxis >= 0) ++naxis;
-    if (spectralAxis >= 0) ++naxis;
-    if (polAxis >= 0) ++naxis;
-
-    // Create the IPosition
-    IPosition pos(naxis);
-    if (latAxis >= 0) pos(latAxis) = latIdx;
-    if (longAxis >= 0) pos(longAxis) = longIdx;
-    if (spectralAxis >= 0) pos(spectralAxis) = spectralIdx;
-    if (polAxis >= 0) pos(polAxis) = polIdx;
-
-    return pos;
+    // Get the pixel sizes then convert the axis sizes to pixels
+    const MVAngle pixelLatSize = MVAngle(abs(dirCoord.increment()(0)));
+    const MVAngle pixelLongSize = MVAngle(abs(dirCoord.increment()(1)));
+    ASKAPCHECK(pixelLatSize == pixelLongSize, "Non-equal pixel sizes not supported");
+    const double majorAxisPixels = majorAxis / pixelLongSize.radian();
+    const double minorAxisPixels = minorAxis / pixelLongSize.radian();
+    disk = DiskEvaluator(pixelPosition(0), pixelPosition(1),
+                         std::max(majorAxisPixels, minorAxisPixels),
+                         std::min(majorAxisPixels, minorAxisPixels),
+                         pa, 1.0);
+
+    // Include every pixel which overlaps the bounding box of the disk, and
+    // don't image the component if none of those are on the image. Pixel i
+    // covers [i - 0.5, i + 0.5).
+    double halfWidthX, halfWidthY;
+    disk.extent(halfWidthX, halfWidthY);
+    const double maxLat = imageShape(latAxis) - 1;
+    const double maxLon = imageShape(longAxis) - 1;
+    const double startLat = std::max(0.0, floor(pixelPosition(0) - halfWidthX + 0.5));
+    const double endLat = std::min(maxLat, floor(pixelPosition(0) + halfWidthX + 0.5));
+    const double startLon = std::max(0.0, floor(pixelPosition(1) - halfWidthY + 0.5));
+    const double endLon = std::min(maxLon, floor(pixelPosition(1) + halfWidthY + 0.5));
+    if (startLat > endLat || startLon > endLon) {
+        return false;
+    }
+    footprint.resize(static_cast<int>(startLat), static_cast<int>(endLat),
+                     static_cast<int>(startLon), static_cast<int>(endLon));
+    return true;
 }
 
-casacore::Flux<casacore::Double> AskapComponentImager::makeFlux(const casacore::SkyComponent& c,
-        const casacore::MFrequency& chanFrequency,
-        const unsigned int term)
+void AskapComponentImager::evaluateDiskFootprint(const DiskEvaluator& disk,
+        ComponentFootprint& footprint,
+        const casacore::uInt firstRow, const casacore::uInt endRow)
 {
-    // Transform flux for the given spectral model
-    Flux<Double> flux;
-    if (c.spectrum().type() == ComponentType::CONSTANT_SPECTRUM) {
-        flux = c.flux().copy();
-
-    } else if (c.spectrum().type() == ComponentType::SPECTRAL_INDEX) {
-        // Scale flux based on spectral index
-        flux = c.flux().copy();
-        const Double scale = c.spectrum().sample(chanFrequency);
-        flux.scaleValue(scale, scale, scale, scale);
+    // Each row of the footprint is a row of pixels along the latitude axis
+    double* data = footprint.data();
+    const uInt nLat = footprint.nLat();
+    for (uInt y = firstRow; y < endRow; ++y) {
+        disk.row(footprint.startLon() + y, footprint.startLat(), nLat, data + y * nLat);
+    }
+}
 
-    } else {
-        ASKAPTHROW(AskapError, "Unsupported spectral model");
-    }
-
-    // Now transform flux for the given taylor term
-    if (term == 0) {
-        // Taylor Term 0
-        // I0 = I(v0)
-    } else if (term == 1) {
-        // Taylor Term 1
-        // I1 = I(v0) * alpha
-        Double alpha = 0.0;
-        if (c.spectrum().type() == ComponentType::SPECTRAL_INDEX) {
-            const casacore::SpectralIndex& spectralModel =
-                dynamic_cast<const casacore::SpectralIndex&>(c.spectrum());
-            alpha = spectralModel.index();
-        }
-        flux.scaleValue(alpha, alpha, alpha, alpha);
-    } else if (term == 2) {
-        // Taylor Term 2
-        // I2 = I(v0) * (0.5 * alpha * (alpha - 1) + beta)
-        Double alpha = 0.0;
-        if (c.spectrum().type() == ComponentType::SPECTRAL_INDEX) {
-            const casacore::SpectralIndex& spectralModel =
-                dynamic_cast<const casacore::SpectralIndex&>(c.spectrum());
-            alpha = spectralModel.index();
-        }
-        const Double beta = 0.0;
-        const Double factor = (0.5 * alpha * (alpha - 1.0) + beta);
-        flux.scaleValue(factor, factor, factor, factor);
-    } else {
-        ASKAPTHROW(AskapError, "Only support taylor terms 0, 1 & 2");
+template <class T, ProjectionOptions::GaussianKernel Kernel>
+size_t AskapComponentImager::evaluateFootprint(const casacore::Gaussian2D<T>& gauss,
+        GaussianRowEvaluator& evaluator,
+        ComponentFootprint& footprint,
+        const casacore::uInt firstRow, const casacore::uInt endRow)
+{
+    // For each pixel in the region bounded by the source centre + cutoff
+    if (gauss.minorAxis() < 1.e-3) {
+        return evaluateLineFootprint(gauss, footprint);
     }
 
-    return flux;
+    // Each row of the footprint is a row of pixels along the latitude axis
+    evaluator.reset(gauss.xCenter(), gauss.yCenter(),
+                    gauss.majorAxis(), gauss.minorAxis(),
+                    gauss.PA(), gauss.flux());
+    double* data = footprint.data();
+    const uInt nLat = footprint.nLat();
+    for (uInt y = firstRow; y < endRow; ++y) {
+        double* row = data + y * nLat;
+        if (Kernel == ProjectionOptions::ANALYTIC) {
+            evaluator.analytic(footprint.startLon() + y, footprint.startLat(), nLat, row);
+        } else if (Kernel == ProjectionOptions::SIMPSON_SINGLE) {
+            evaluator.simpsonSingle(footprint.startLon() + y, footprint.startLat(), nLat, row);
+        } else {
+            evaluator.simpson(footprint.startLon() + y, footprint.startLat(), nLat, row);
+        }
+    }
+    return static_cast<size_t>(nLat) * (endRow - firstRow);
 }
 
 template <class T>
 int AskapComponentImager::findCutoff(const Gaussian2D<T>& gauss, const int spatialLimit,
                                      const double fluxLimit)
 {
-    // Make a copy of the gaussian and set the PA to zero so this function can
-    // walk the major axis easily, to determine the cutoff. The major axis is
-    // parallel with the y axis when the position angle is zero.
-    Gaussian2D<T> g = gauss;
-    g.setPA(0.0);
+    // Along the major axis the gaussian is height * exp(-r^2 / (2 sigma^2)),
+    // which falls to the flux limit at r = sigma * sqrt(2 ln(height / limit)).
+    // The cutoff is the first whole pixel beyond that point.
+    const double height = std::abs(static_cast<double>(gauss.height()));
+    if (height < fluxLimit) {
+        return 0;
+    }
+    const double sigma = gauss.majorAxis() / (2. * M_SQRT2 * sqrt(M_LN2));
+    const double r = sigma * sqrt(2. * log(height / fluxLimit));
+    if (r >= spatialLimit) {
+        return spatialLimit + 1;
+    }
+    return static_cast<int>(floor(r)) + 1;
+}
 
-    int cutoff = 0;
-    while ((cutoff <= spatialLimit) &&
-            abs(g(g.xCenter(), g.yCenter() + cutoff) >= fluxLimit)) {
-        ++cutoff;
+template <class T>
+void AskapComponentImager::findExtent(const Gaussian2D<T>& gauss, const double maxFlux,
+                                      const ProjectionOptions& options,
+                                      double& halfWidthX, double& halfWidthY)
+{
+    const double fwhmToSigma = 1. / (2. * M_SQRT2 * sqrt(M_LN2));
+    const double sigmaMajor = gauss.majorAxis() * fwhmToSigma;
+    const double sigmaMinor = gauss.minorAxis() * fwhmToSigma;
+
+    // Find the number of standard deviations at which to truncate
+    double nSigma = 0.;
+    switch (options.cutoffPolicy) {
+        case ProjectionOptions::RELATIVE_TO_PEAK:
+            nSigma = sqrt(-2. * log(options.cutoffValue));
+            break;
+
+        case ProjectionOptions::ABSOLUTE_FLUX: {
+            // If the peak is below the floor, only the pixel(s) containing
+            // the centre are kept
+            const double peak = maxFlux / (2. * M_PI * sigmaMajor * sigmaMinor);
+            if (peak > options.cutoffValue) {
+                nSigma = sqrt(2. * log(peak / options.cutoffValue));
+            }
+            break;
+        }
+
+        case ProjectionOptions::N_SIGMA:
+            nSigma = options.cutoffValue;
+            break;
+
+        default:
+            ASKAPTHROW(AskapError, "Unsupported cutoff policy");
+            break;
     }
-    return cutoff;
+
+    // The contour is an ellipse with semi-major axis nSigma * sigmaMajor along
+    // the y axis, rotated by the position angle. These are the half widths of
+    // its bounding box.
+    const double cpa = cos(gauss.PA());
+    const double spa = sin(gauss.PA());
+    const double major = nSigma * sigmaMajor;
+    const double minor = nSigma * sigmaMinor;
+    halfWidthX = sqrt(cpa * cpa * minor * minor + spa * spa * major * major);
+    halfWidthY = sqrt(spa * spa * minor * minor + cpa * cpa * major * major);
 }
 
 template <class T>
 double AskapComponentImager::evaluateGaussian(const Gaussian2D<T> &gauss,
-        const int xpix, const int ypix)
+        const int xpix, const int ypix,
+        const ProjectionOptions::GaussianKernel kernel)
 {
     // If we have a very narrow Gaussian, calculate the pixel flux
     // using the 1D approach. Otherwise, we need to do a 2D integral.
     if (gauss.minorAxis() < 1.e-3) {
         return evaluateGaussian1D<T>(gauss, xpix, ypix);
+    } else if (kernel == ProjectionOptions::ANALYTIC) {
+        return evaluateGaussianAnalytic<T>(gauss, xpix, ypix);
+    } else if (kernel == ProjectionOptions::SIMPSON_SINGLE) {
+        GaussianRowEvaluator evaluator(gauss.xCenter(), gauss.yCenter(),
+                                       gauss.majorAxis(), gauss.minorAxis(),
+                                       gauss.PA(), gauss.flux());
+        double flux;
+        evaluator.simpsonSingle(ypix, xpix, 1, &flux);
+        return flux;
     } else {
         return evaluateGaussian2D<T>(gauss, xpix, ypix);
     }
@@ -452,131 +2147,118 @@ double AskapComponentImager::evaluateGaussian2D(const Gaussian2D<T> &gauss,
     return pixelVal;
 }
 
+template <class T>
+double AskapComponentImager::evaluateGaussianAnalytic(const Gaussian2D<T> &gauss,
+        const int xpix, const int ypix)
+{
+    GaussianRowEvaluator evaluator(gauss.xCenter(), gauss.yCenter(),
+                                   gauss.majorAxis(), gauss.minorAxis(),
+                                   gauss.PA(), gauss.flux());
+    double pixelVal = 0.;
+    evaluator.analytic(ypix, xpix, 1, &pixelVal);
+    return pixelVal;
+}
+
 template <class T>
 double AskapComponentImager::evaluateGaussian1D(const Gaussian2D<T> &gauss,
         const int xpix, const int ypix)
 {
     // This approach represents the Gaussian as a one-dimensional
-    // line, and finds the points where that line intercepts the
-    // borders of the given pixel. Note that the provided (integral)
-    // position is assumed to be at the centre of the pixel. If the
-    // line does not intercept the pixel, the flux for the pixel is
-    // zero.
-
-    // ASKAPLOG_DEBUG_STR(logger, "1d Gaussian evalution, at " << xpix << "," << ypix);
-
-    // boundaries of the pixel
-    double ypixmax = ypix + 0.5;
-    double ypixmin = ypix - 0.5;
-    double xpixmin = xpix - 0.5;
-    double xpixmax = xpix + 0.5;
-    // ASKAPLOG_DEBUG_STR(logger, "Pixel ranges: xpixmin="<<xpixmin<<", xpixmax="<<xpixmax<<
-    //                    ",  ypixmin="<<ypixmin<<", ypixmax="<<ypixmax);
-
-    // properties of the (2D) gaussian
-    double x0gauss = gauss.xCenter();
-    double y0gauss = gauss.yCenter();
-    double sigma = gauss.majorAxis() / (2. * M_SQRT2 * sqrt(M_LN2));
-    // ASKAPLOG_DEBUG_STR(logger, "Centre of Gaussian = ("<<x0gauss << "," << y0gauss << ", pa="<<gauss.PA()*180./M_PI);
-
-    // Find where the line intersectes the pixel boundaries
-    std::vector<std::pair<double, double> > interceptList;
-
-    if (fabs(gauss.PA()) < 1.e-6) {
-        // vertical line - simplifies things
-        if ((x0gauss >= xpixmin) && (x0gauss < xpixmax)) {
-            // if we are in the pixel
-            interceptList.push_back(std::pair<double, double>(x0gauss, ypixmin));
-            interceptList.push_back(std::pair<double, double>(x0gauss, ypixmax));
-        }
-    } else if (fabs(gauss.PA() - M_PI / 2.) < 1.e-6) {
-        // horizontal line
-        if ((y0gauss >= ypixmin) && (y0gauss < ypixmax)) {
-            // if we are in the pixel
-            interceptList.push_back(std::pair<double, double>(xpixmin, y0gauss));
-            interceptList.push_back(std::pair<double, double>(xpixmax, y0gauss));
-        }
-
-    } else {
-        // general case of angled line. Need to find (up to) two points where
-        // the line intersects the pixel boundaries
-        // xminInt = x-value where line intersects bottom pixel boundary
-        // xmaxInt = x-value where line intersects top pixel boundary
-        // yminInt = y-value where line intersects left pixel boundary
-        // ymaxInt = y-value where line intersects right pixel boundary
-
-        double gaussianSlope = tan(gauss.PA() - M_PI / 2.);
-        double xminInt = x0gauss + (ypixmin - y0gauss) / gaussianSlope;
-        double xmaxInt = x0gauss + (ypixmax - y0gauss) / gaussianSlope;
-        double yminInt = y0gauss + (xpixmin - x0gauss) * gaussianSlope;
-        double ymaxInt = y0gauss + (xpixmax - x0gauss) * gaussianSlope;
-
-        // ASKAPLOG_DEBUG_STR(logger, "intercepts: " << xminInt << " " << yminInt << " " << xmaxInt << " " << ymaxInt);
-
-        if ((xminInt >= xpixmin) && (xminInt < xpixmax)) {
-            interceptList.push_back(std::pair<double, double>(xminInt, ypixmin));
-        }
-        if ((xmaxInt >= xpixmin) && (xmaxInt < xpixmax)) {
-            interceptList.push_back(std::pair<double, double>(xmaxInt, ypixmax));
-        }
-        if ((yminInt >= ypixmin) && (yminInt < ypixmax)) {
-            interceptList.push_back(std::pair<double, double>(xpixmin, yminInt));
-        }
-        if ((ymaxInt >= ypixmin) && (ymaxInt < ypixmax)) {
-            interceptList.push_back(std::pair<double, double>(xpixmax, ymaxInt));
-        }
-
+    // line, and finds the section of that line which crosses the
+    // given pixel. Note that the provided (integral) position is
+    // assumed to be at the centre of the pixel. If the line does
+    // not cross the pixel, the flux for the pixel is zero.
+    const LineGaussian line(gauss);
+    double t0, t1;
+    if (!line.clip(xpix - 0.5, xpix + 0.5, ypix - 0.5, ypix + 0.5, t0, t1)) {
+        return 0.;
     }
+    return line.halfFlux * (erf(t1 * line.zScale) - erf(t0 * line.zScale));
+}
 
-    double pixelVal = 0.;
-    if (interceptList.size() == 2) {
+template <class T>
+size_t AskapComponentImager::evaluateLineFootprint(const casacore::Gaussian2D<T>& gauss,
+        ComponentFootprint& footprint)
+{
+    // Clip the line to the footprint, then step along it from one pixel
+    // boundary to the next. Each step is the section of the line within a
+    // single pixel, and the error function at each boundary is shared by
+    // the pixels either side of it.
+    const LineGaussian line(gauss);
+    const int startLat = footprint.startLat();
+    const int startLon = footprint.startLon();
+    const int endLat = startLat + static_cast<int>(footprint.nLat()) - 1;
+    const int endLon = startLon + static_cast<int>(footprint.nLon()) - 1;
+    double t0, t1;
+    if (!line.clip(startLat - 0.5, endLat + 0.5, startLon - 0.5, endLon + 0.5, t0, t1)) {
+        return 0;
+    }
 
-        // Find the locations of the two intercept points in the
-        // coordinates *along* the line, in units of the sigma value
-        // (ie. standard 'z-score' values)
-        std::vector<double> z(2);
-        for (int i = 0; i < 2; i++) {
-            z[i] = hypot(x0gauss - interceptList[i].first,
-                         y0gauss - interceptList[i].second) / sigma;
-            if (y0gauss > interceptList[i].second) {
-                // Make displacement negative for points below the centre
-                z[i] *= -1.;
+    // The boundaries are at half integer positions. Find the first of
+    // each axis beyond the start of the line, and the distance along the
+    // line between consecutive boundaries.
+    const double inf = std::numeric_limits<double>::infinity();
+    const double x0 = line.xCenter + t0 * line.dx;
+    const double y0 = line.yCenter + t0 * line.dy;
+    const double xStep = (line.dx > 0.) ? 1. : -1.;
+    const double yStep = (line.dy > 0.) ? 1. : -1.;
+    double xBoundary = (line.dx > 0.) ? floor(x0 - 0.5) + 1.5 : ceil(x0 - 0.5) - 0.5;
+    double yBoundary = (line.dy > 0.) ? floor(y0 - 0.5) + 1.5 : ceil(y0 - 0.5) - 0.5;
+    double tx = (line.dx != 0.) ? (xBoundary - line.xCenter) / line.dx : inf;
+    double ty = (line.dy != 0.) ? (yBoundary - line.yCenter) / line.dy : inf;
+
+    size_t nCrossed = 0;
+    double tStart = t0;
+    double erfStart = erf(t0 * line.zScale);
+    while (tStart < t1) {
+        const double tEnd = std::min(t1, std::min(tx, ty));
+        if (tEnd > tStart) {
+            const double tMid = 0.5 * (tStart + tEnd);
+            const int x = static_cast<int>(floor(line.xCenter + tMid * line.dx + 0.5));
+            const int y = static_cast<int>(floor(line.yCenter + tMid * line.dy + 0.5));
+            const double erfEnd = erf(tEnd * line.zScale);
+            if (x >= startLat && x <= endLat && y >= startLon && y <= endLon) {
+                footprint(x - startLat, y - startLon) += line.halfFlux * (erfEnd - erfStart);
+                ++nCrossed;
             }
+            erfStart = erfEnd;
+        }
+        tStart = tEnd;
+        if (tx <= tEnd) {
+            xBoundary += xStep;
+            tx = (xBoundary - line.xCenter) / line.dx;
+        }
+        if (ty <= tEnd) {
+            yBoundary += yStep;
+            ty = (yBoundary - line.yCenter) / line.dy;
         }
-
-        // Make a 1D gaussian to get the height correct, since if the
-        // 2D gaussian's minor axis is really small, then the height
-        // will be massive for a reasonable (integrated) flux. We
-        // define with the height, but set the flux directly (which
-        // will implicitly reset the height value).
-
-        casacore::Gaussian1D<T> gauss1d(gauss.height(), 0., gauss.majorAxis());
-        gauss1d.setFlux(gauss.flux());
-        // ASKAPLOG_DEBUG_STR(logger, "Defined a 1D Gaussian with height=" << gauss1d.height() << ", flux="<<
-        //                    gauss1d.flux() << " and FWHM="<<gauss1d.width());
-
-        // Find the flux via a different in error-function values for the two intercept points
-        pixelVal = gauss1d.flux() * fabs(0.5 * (erf(z[0] / (M_SQRT2 * sigma)) - erf(z[1] / (M_SQRT2 * sigma))));
-
-        // ASKAPLOG_DEBUG_STR(logger, "Flux of " << pixelVal << " between z=["<<z[0]<<","<<z[1] <<
-        //                    "] or pixel locations ("<<interceptList[0].first<<","<<interceptList[0].second <<
-        //                    ") & ("<<interceptList[1].first<<","<<interceptList[1].second <<")");
-
-    } else {
-        // Line does not intersect this pixel. Flux = 0.
-        pixelVal = 0.;
     }
-
-    return pixelVal;
+    return nCrossed;
 }
 
 
 // Explicit instantiation
 template void AskapComponentImager::project(casacore::ImageInterface<float>&,
-        const casacore::ComponentList&, const unsigned int);
+        const casacore::ComponentList&, const unsigned int, const ProjectionOptions&);
+template void AskapComponentImager::project(casacore::ImageInterface<double>&,
+        const casacore::ComponentList&, const unsigned int, const ProjectionOptions&);
+template void AskapComponentImager::project(const std::vector<casacore::ImageInterface<float>*>&,
+        const casacore::ComponentList&, const ProjectionOptions&);
+template void AskapComponentImager::project(const std::vector<casacore::ImageInterface<double>*>&,
+        const casacore::ComponentList&, const ProjectionOptions&);
+template void AskapComponentImager::project(casacore::ImageInterface<float>&,
+        const ComponentCatalogue&, const unsigned int, const ProjectionOptions&);
 template void AskapComponentImager::project(casacore::ImageInterface<double>&,
-        const casacore::ComponentList&, const unsigned int);
+        const ComponentCatalogue&, const unsigned int, const ProjectionOptions&);
+template void AskapComponentImager::project(const std::vector<casacore::ImageInterface<float>*>&,
+        const ComponentCatalogue&, const ProjectionOptions&);
+template void AskapComponentImager::project(const std::vector<casacore::ImageInterface<double>*>&,
+        const ComponentCatalogue&, const ProjectionOptions&);
+template void AskapComponentImager::project(SparseModel<float>&,
+        const casacore::ComponentList&, const unsigned int, const ProjectionOptions&);
+template void AskapComponentImager::project(SparseModel<double>&,
+        const casacore::ComponentList&, const unsigned int, const ProjectionOptions&);
 template double AskapComponentImager::evaluateGaussian(const casacore::Gaussian2D<float> &gauss,
-        const int xpix, const int ypix);
+        const int xpix, const int ypix, const ProjectionOptions::GaussianKernel kernel);
 template double AskapComponentImager::evaluateGaussian(const casacore::Gaussian2D<double> &gauss,
-        const int xpix, const int ypix);
+        const int xpix, const int ypix, const ProjectionOptions::GaussianKernel kernel);
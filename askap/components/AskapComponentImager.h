@@ -28,6 +28,9 @@
 #ifndef ASKAP_COMPONENTS_ASKAPCOMPONENTIMAGER_H
 #define ASKAP_COMPONENTS_ASKAPCOMPONENTIMAGER_H
 
+// System includes
+#include <vector>
+
 // ASKAPsoft includes
 #include "casacore/casa/aipstype.h"
 #include "casacore/images/Images/ImageInterface.h"
@@ -37,9 +40,19 @@
 #include "casacore/coordinates/Coordinates/DirectionCoordinate.h"
 #include "casacore/measures/Measures/Stokes.h"
 #include "casacore/casa/Arrays/IPosition.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Array.h"
 #include "components/ComponentModels/Flux.h"
 #include "casacore/scimath/Functionals/Gaussian2D.h"
 
+// Local package includes
+#include "ComponentCatalogue.h"
+#include "ComponentFootprint.h"
+#include "DiskEvaluator.h"
+#include "GaussianRowEvaluator.h"
+#include "ProjectionOptions.h"
+#include "SparseModel.h"
+
 namespace askap {
 namespace components {
 
@@ -63,10 +76,76 @@ class AskapComponentImager {
         /// @param[inout] image the image onto which the components will be projected.
         /// @param[in] list the list of components to project.
         /// @param[in] term the taylor term to image.
+        /// @param[in] options  options controlling how the image is rendered.
         template <class T>
         static void project(casacore::ImageInterface<T>& image,
                             const casacore::ComponentList& list,
-                            const unsigned int term = 0);
+                            const unsigned int term = 0,
+                            const ProjectionOptions& options = ProjectionOptions());
+
+        /// Project the componentlist onto one image per taylor term, where
+        /// images[t] receives taylor term t (so there can be at most three).
+        /// Only the flux differs between the terms, so the pixel position and
+        /// footprint of each component are calculated once and used for all
+        /// of the images. The footprint is sized for the brightest term, so a
+        /// fainter term may include pixels which a single term call would
+        /// have cut off.
+        ///
+        /// @param[inout] images    the images onto which the components will be
+        ///                         projected. These must all have the same shape
+        ///                         and coordinate system.
+        /// @param[in] list the list of components to project.
+        /// @param[in] options  options controlling how the images are rendered.
+        template <class T>
+        static void project(const std::vector<casacore::ImageInterface<T>*>& images,
+                            const casacore::ComponentList& list,
+                            const ProjectionOptions& options = ProjectionOptions());
+
+        /// Project a component catalogue onto the image. The result is the
+        /// same as for a list of the same components, but no SkyComponent is
+        /// created, and the catalogue columns are read as they are used. The
+        /// directions of the catalogue must be in the reference frame of the
+        /// image's direction coordinate, and the componentIndex, positionCache
+        /// and spectralModels options, which refer to a list, are not supported.
+        ///
+        /// @param[inout] image the image onto which the components will be projected.
+        /// @param[in] catalogue    the catalogue of components to project.
+        /// @param[in] term the taylor term to image.
+        /// @param[in] options  options controlling how the image is rendered.
+        template <class T>
+        static void project(casacore::ImageInterface<T>& image,
+                            const ComponentCatalogue& catalogue,
+                            const unsigned int term = 0,
+                            const ProjectionOptions& options = ProjectionOptions());
+
+        /// Project a component catalogue onto one image per taylor term, as
+        /// for the list overload.
+        ///
+        /// @param[inout] images    the images onto which the components will be
+        ///                         projected. These must all have the same shape
+        ///                         and coordinate system.
+        /// @param[in] catalogue    the catalogue of components to project.
+        /// @param[in] options  options controlling how the images are rendered.
+        template <class T>
+        static void project(const std::vector<casacore::ImageInterface<T>*>& images,
+                            const ComponentCatalogue& catalogue,
+                            const ProjectionOptions& options = ProjectionOptions());
+
+        /// Project the componentlist onto a sparse model, rather than a dense
+        /// image. The model receives exactly the values which would be added
+        /// to an image of the same shape and coordinate system, other than
+        /// pixels to which nothing is added, and is compacted on return.
+        /// The channelBlockMemory and writeQueueDepth options are not used.
+        ///
+        /// @param[inout] model the model onto which the components will be projected.
+        /// @param[in] list the list of components to project.
+        /// @param[in] term the taylor term to image.
+        /// @param[in] options  options controlling how the model is rendered.
+        template <class T>
+        static void project(SparseModel<T>& model,
+                            const casacore::ComponentList& list,
+                            const unsigned int term = 0,
+                            const ProjectionOptions& options = ProjectionOptions());
 
 
         /// @brief Front-end to the different functions for calculating
@@ -74,85 +153,149 @@ class AskapComponentImager {
         /// @param[in] gauss       the gaussian function to be evaluated
         /// @param[in] xpix        the x-coordinate of the pixel
         /// @param[in] ypix        the y-coordinate of the pixel
+        /// @param[in] kernel      the method used to integrate over the pixel
         template <class T>
         static double evaluateGaussian(const casacore::Gaussian2D<T> &gauss,
-                                       const int xpix, const int ypix);
+                                       const int xpix, const int ypix,
+                                       const ProjectionOptions::GaussianKernel kernel =
+                                           ProjectionOptions::SIMPSON);
 
     private:
-        /// Project a point shape on to the image
-        template <class T>
-        static void projectPointShape(casacore::ImageInterface<T>& image,
-                                      const casacore::SkyComponent& c,
-                                      const casacore::Int latAxis, const casacore::Int longAxis,
-                                      const casacore::DirectionCoordinate& dirCoord,
-                                      const casacore::Int freqAxis, const casacore::uInt freqIdx,
-                                      const casacore::Flux<casacore::Double>& flux,
-                                      const casacore::Int polAxis, const casacore::uInt polIdx,
-                                      const casacore::Stokes::StokesTypes& stokes);
-
-        /// Project a gaussian shape on to the image
+        /// Project the components onto a set of images which share a pixel
+        /// grid, where images[t] receives taylor term terms[t]. If sparse is
+        /// not null then images must be empty, and the single term is
+        /// projected onto the sparse model instead. The components are read
+        /// through an adapter for either a ComponentList or a ComponentCatalogue.
+        template <class T, class Components>
+        static void projectTerms(const std::vector<casacore::ImageInterface<T>*>& images,
+                                 SparseModel<T>* sparse,
+                                 const std::vector<unsigned int>& terms,
+                                 const Components& components,
+                                 const ProjectionOptions& options);
+
+        /// Create the footprint of a point shape.
+        ///
+        /// @param[in] pixelPosition    the (lat, lon) pixel position of the component.
+        /// @param[in] imageShape       the shape of the image.
+        /// @param[in] latAxis          the pixel axis number of the latitude axis.
+        /// @param[in] longAxis         the pixel axis number of the longitude axis.
+        /// @param[out] footprint       the unit flux footprint of the component.
+        /// @return false if the component falls outside the image, otherwise true.
+        static bool makePointFootprint(const casacore::Vector<casacore::Double>& pixelPosition,
+                                       const casacore::IPosition& imageShape,
+                                       const casacore::Int latAxis, const casacore::Int longAxis,
+                                       ComponentFootprint& footprint);
+
+        /// Create the gaussian function for a gaussian shape, and size its
+        /// footprint. The footprint values are calculated separately by
+        /// evaluateFootprint(), which does not depend on any casacore state
+        /// shared between components, so may be called concurrently for
+        /// different components. With a restoring beam the gaussian is
+        /// convolved with the beam, and its flux is the area of the beam.
+        ///
+        /// @param[in] shape            the component shape, which must be a gaussian,
+        ///                             or a point when restoring.
+        /// @param[in] majorAxis        the major axis of a gaussian, in radians.
+        /// @param[in] minorAxis        the minor axis of a gaussian, in radians.
+        /// @param[in] pa               the position angle of a gaussian, in radians.
+        /// @param[in] pixelPosition    the (lat, lon) pixel position of the component.
+        /// @param[in] imageShape       the shape of the image.
+        /// @param[in] latAxis          the pixel axis number of the latitude axis.
+        /// @param[in] longAxis         the pixel axis number of the longitude axis.
+        /// @param[in] dirCoord         the direction coordinate of the image.
+        /// @param[in] maxFlux          the largest absolute flux this component has
+        ///                             in any image plane. This governs the cutoff.
+        /// @param[in] options          the options, which give the cutoff policy
+        ///                             and any restoring beam.
+        /// @param[out] gauss           the unit flux gaussian function, in pixel
+        ///                             coordinates.
+        /// @param[out] footprint       the footprint of the component, sized to
+        ///                             the cutoff but with values not yet set.
+        /// @return false if the component falls outside the image, otherwise true.
         template <class T>
-        static void projectGaussianShape(casacore::ImageInterface<T>& image,
-                                         const casacore::SkyComponent& c,
-                                         const casacore::Int latAxis, const casacore::Int longAxis,
-                                         const casacore::DirectionCoordinate& dirCoord,
-                                         const casacore::Int freqAxis, const casacore::uInt freqIdx,
-                                         const casacore::Flux<casacore::Double>& flux,
-                                         const casacore::Int polAxis, const casacore::uInt polIdx,
-                                         const casacore::Stokes::StokesTypes& stokes);
-
-        /// Make an IPosition given the passed axis information.
-        /// The returned IPosition will have one dimension for each of latAxis,
-        /// longAxis, spectralAxis, and polAxis which have values >= 0. The index
-        /// values are per the *Idx parameters.
-        ///
-        /// @param[in] latAxis the (zero based) index number on which the latitude
-        ///            axis exists, or a negative number if the latitude axis is
-        ///            not present.
-        /// @param[in] longAxis the (zero based) index number on which the longitude
-        ///            axis exists, or a negative number if the longitude axis is
-        ///            not present.
-        /// @param[in] spectralAxis the (zero based) index number on which the spectral
-        ///            axis exists, or a negative number if the spectral axis is
-        ///            not present.
-        /// @param[in] polAxis the (zero based) index number on which the polarisation
-        ///            axis exists, or a negative number if the polarisation axis is
-        ///            not present.
-        ///
-        /// @param[in] latIdx   the index value on the latitude axis in the
-        ///                     returned IPosition instance.
-        /// @param[in] longIdx the index value on the longitude axis in the
-        ///                     returned IPosition instance.
-        /// @param[in] spectralIdx  the index value on the latitude axis in the
-        ///                         returned IPosition instance.
-        /// @param[in] polIdx   the index value on the polarisation axis in the
-        ///                     returned IPosition instance.
-        ///
-        /// @return an IPosition object which represents all in the input parameters.
-        static casacore::IPosition makePosition(const casacore::Int latAxis, const casacore::Int longAxis,
-                                            const casacore::Int spectralAxis, const casacore::Int polAxis,
-                                            const casacore::uInt latIdx, const casacore::uInt longIdx,
-                                            const casacore::uInt spectralIdx, const casacore::uInt polIdx);
-
-        /// Given a SkyComponent, determine the flux value (or appropriate
-        /// value for talylor terms > 0) for the given channel frequency.
-        ///
-        /// @param[in] c    the sky component for which the flux value will
-        ///                 be calculated.
-        /// @param[in] chanFrequency    the channel frequency for which the flux
-        ///                             is to be calculated.
-        /// @param[in] term the taylor term to calculate the value for.
-        static casacore::Flux<casacore::Double> makeFlux(const casacore::SkyComponent& c,
-                const casacore::MFrequency& chanFrequency,
-                const unsigned int term);
+        static bool makeGaussian(const casacore::ComponentType::Shape shape,
+                                 const double majorAxis, const double minorAxis,
+                                 const double pa,
+                                 const casacore::Vector<casacore::Double>& pixelPosition,
+                                 const casacore::IPosition& imageShape,
+                                 const casacore::Int latAxis, const casacore::Int longAxis,
+                                 const casacore::DirectionCoordinate& dirCoord,
+                                 const double maxFlux,
+                                 const ProjectionOptions& options,
+                                 casacore::Gaussian2D<T>& gauss,
+                                 ComponentFootprint& footprint);
+
+        /// Create the evaluator for a disk shape, and size its footprint to the
+        /// bounding box of the disk. As for makeGaussian(), the footprint values
+        /// are calculated separately, by evaluateDiskFootprint().
+        ///
+        /// @param[in] majorAxis        the major axis of the disk, in radians.
+        /// @param[in] minorAxis        the minor axis of the disk, in radians.
+        /// @param[in] pa               the position angle of the disk, in radians.
+        /// @param[in] pixelPosition    the (lat, lon) pixel position of the component.
+        /// @param[in] imageShape       the shape of the image.
+        /// @param[in] latAxis          the pixel axis number of the latitude axis.
+        /// @param[in] longAxis         the pixel axis number of the longitude axis.
+        /// @param[in] dirCoord         the direction coordinate of the image.
+        /// @param[out] disk            the unit flux disk, in pixel coordinates.
+        /// @param[out] footprint       the footprint of the component, sized to
+        ///                             the disk but with values not yet set.
+        /// @return false if the disk does not overlap the image, otherwise true.
+        static bool makeDisk(const double majorAxis, const double minorAxis,
+                             const double pa,
+                             const casacore::Vector<casacore::Double>& pixelPosition,
+                             const casacore::IPosition& imageShape,
+                             const casacore::Int latAxis, const casacore::Int longAxis,
+                             const casacore::DirectionCoordinate& dirCoord,
+                             DiskEvaluator& disk,
+                             ComponentFootprint& footprint);
+
+        /// Evaluate the disk for rows [firstRow, endRow) of the footprint
+        /// (along the latitude axis), as the exact area of overlap of each
+        /// pixel and the disk. The rows of a large footprint can then be
+        /// divided between threads.
+        ///
+        /// @param[in] disk             the unit flux disk.
+        /// @param[inout] footprint     the footprint, as sized by makeDisk().
+        /// @param[in] firstRow         the first row to evaluate.
+        /// @param[in] endRow           one past the last row to evaluate.
+        static void evaluateDiskFootprint(const DiskEvaluator& disk,
+                                          ComponentFootprint& footprint,
+                                          const casacore::uInt firstRow,
+                                          const casacore::uInt endRow);
+
+        /// Evaluate the gaussian for rows [firstRow, endRow) of the
+        /// footprint. The pixels are evaluated a row (along the latitude axis,
+        /// which is contiguous in the footprint) at a time with a
+        /// GaussianRowEvaluator, so the rows of a large footprint can be
+        /// divided between threads. Very narrow gaussians use
+        /// evaluateLineFootprint(), and are always evaluated whole.
+        ///
+        /// The integration kernel is a template parameter, so it is chosen
+        /// once for a batch of gaussians rather than for each row.
+        ///
+        /// @param[in] gauss            the unit flux gaussian function.
+        /// @param[inout] evaluator     scratch space, which is reset for this
+        ///                             gaussian so its storage is reused.
+        /// @param[inout] footprint     the footprint, as sized by makeGaussian().
+        /// @param[in] firstRow         the first row to evaluate.
+        /// @param[in] endRow           one past the last row to evaluate.
+        /// @return the number of pixels evaluated.
+        template <class T, ProjectionOptions::GaussianKernel Kernel>
+        static size_t evaluateFootprint(const casacore::Gaussian2D<T>& gauss,
+                                      GaussianRowEvaluator& evaluator,
+                                      ComponentFootprint& footprint,
+                                      const casacore::uInt firstRow,
+                                      const casacore::uInt endRow);
 
         /// Determine the number of pixels to sample before the gaussian tapers
         /// off to below the flux limit.
         ///
-        /// This function samples the gaussian in the x and y dimensions and returns
-        /// the number of pixels at which the gaussian has tapered off in both
-        /// dimensions. That is, it keeps testing in both directions and will return
-        /// when both sampled fluxes are < fluxLimit or when cutoff is > spatialLimit.
+        /// This function finds the distance along the major axis at which the
+        /// gaussian falls below the flux limit, and returns the number of pixels
+        /// to that point. That is, the smallest whole number of pixels at which
+        /// the sampled flux is < fluxLimit, but no more than spatialLimit + 1.
+        /// The distance is calculated analytically from the gaussian parameters.
         ///
         /// @param[in] gauss        the gaussian function for which the cutoff is
         ///                         to be calcuated.
@@ -166,6 +309,21 @@ class AskapComponentImager {
         static int findCutoff(const casacore::Gaussian2D<T>& gauss, const int spatialLimit,
                               const double fluxLimit);
 
+        /// Determine the half widths, in pixels along each pixel axis, of the
+        /// bounding box of the contour at which a gaussian is truncated.
+        ///
+        /// @param[in] gauss        the gaussian function, which gives the
+        ///                         shape and position angle.
+        /// @param[in] maxFlux      the flux of the gaussian in the brightest plane.
+        /// @param[in] options      the options, which give the cutoff policy. The
+        ///                         policy cannot be MACHINE_EPSILON.
+        /// @param[out] halfWidthX  the half width along the x (latitude) axis.
+        /// @param[out] halfWidthY  the half width along the y (longitude) axis.
+        template <class T>
+        static void findExtent(const casacore::Gaussian2D<T>& gauss, const double maxFlux,
+                               const ProjectionOptions& options,
+                               double& halfWidthX, double& halfWidthY);
+
         /// @brief Calculate the flux in a single pixel due to a 2D
         /// Gaussian component. This integrates over the pixel to
         /// accurately measure the flux going in, thereby taking into
@@ -180,6 +338,23 @@ class AskapComponentImager {
         static double evaluateGaussian2D(const casacore::Gaussian2D<T> &gauss,
                                          const int xpix, const int ypix);
 
+        /// @brief Calculate the flux in a single pixel due to a 2D
+        /// Gaussian component, integrating analytically where possible.
+        /// For each y the integral over the pixel in x is a difference of
+        /// error functions. The remaining integral over y is also analytic
+        /// when the Gaussian's axes are aligned with the pixel grid, and
+        /// otherwise uses 6 point Gauss-Legendre quadrature on panels no
+        /// wider than twice the minor axis sigma. The absolute error is below
+        /// 1e-8 of the component flux. The pixel location given (integer
+        /// numbers) is assumed to be at the centre of the pixel. This is
+        /// the single pixel case of GaussianRowEvaluator::analytic().
+        /// @param[in] gauss       the gaussian function to be evaluated
+        /// @param[in] xpix        the x-coordinate of the pixel
+        /// @param[in] ypix        the y-coordinate of the pixel
+        template <class T>
+        static double evaluateGaussianAnalytic(const casacore::Gaussian2D<T> &gauss,
+                                               const int xpix, const int ypix);
+
         /// @brief Calculate the flux in a single pixel due to a
         /// one-dimensional Gaussian component - that is, a 2D
         /// Gaussian component with zero minor axis size. This allows
@@ -194,21 +369,55 @@ class AskapComponentImager {
         static double evaluateGaussian1D(const casacore::Gaussian2D<T> &gauss,
                                          const int xpix, const int ypix);
 
+        /// Evaluate a one-dimensional Gaussian component (as for
+        /// evaluateGaussian1D()) for every pixel of the footprint. Only
+        /// the pixels which the line crosses are visited, by stepping
+        /// along the line from one pixel boundary to the next, and the
+        /// error function is evaluated once per boundary. The other
+        /// pixels are left at zero.
+        ///
+        /// @param[in] gauss            the unit flux gaussian function.
+        /// @param[inout] footprint     the footprint, as sized by makeGaussian().
+        /// @return the number of pixels the line crosses.
+        template <class T>
+        static size_t evaluateLineFootprint(const casacore::Gaussian2D<T>& gauss,
+                                          ComponentFootprint& footprint);
+
 };
 
 // Explicit instantiations exist for float and double types only
 extern template void
 AskapComponentImager::project(casacore::ImageInterface<float>&,
-                              const casacore::ComponentList&, const unsigned int);
+                              const casacore::ComponentList&, const unsigned int,
+                              const ProjectionOptions&);
 extern template void
 AskapComponentImager::project(casacore::ImageInterface<double>&,
-                              const casacore::ComponentList&, const unsigned int);
+                              const casacore::ComponentList&, const unsigned int,
+                              const ProjectionOptions&);
+extern template void
+AskapComponentImager::project(const std::vector<casacore::ImageInterface<float>*>&,
+                              const casacore::ComponentList&,
+                              const ProjectionOptions&);
+extern template void
+AskapComponentImager::project(const std::vector<casacore::ImageInterface<double>*>&,
+                              const casacore::ComponentList&,
+                              const ProjectionOptions&);
+extern template void
+AskapComponentImager::project(SparseModel<float>&,
+                              const casacore::ComponentList&, const unsigned int,
+                              const ProjectionOptions&);
+extern template void
+AskapComponentImager::project(SparseModel<double>&,
+                              const casacore::ComponentList&, const unsigned int,
+                              const ProjectionOptions&);
 extern template double
 AskapComponentImager::evaluateGaussian(const casacore::Gaussian2D<float> &gauss,
-                                       const int xpix, const int ypix);
+                                       const int xpix, const int ypix,
+                                       const ProjectionOptions::GaussianKernel kernel);
 extern template double
 AskapComponentImager::evaluateGaussian(const casacore::Gaussian2D<double> &gauss,
-                                       const int xpix, const int ypix);
+                                       const int xpix, const int ypix,
+                                       const ProjectionOptions::GaussianKernel kernel);
 
 }
 }
@@ -0,0 +1,266 @@
+/// @file ComponentCatalogue.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "ComponentCatalogue.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/measures/Measures/MDirection.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "components/ComponentModels/SkyComponent.h"
+#include "components/ComponentModels/ComponentList.h"
+#include "components/ComponentModels/ComponentShape.h"
+#include "components/ComponentModels/TwoSidedShape.h"
+#include "components/ComponentModels/ComponentType.h"
+
+// Local package includes
+#include "ComponentFluxTable.h"
+
+using namespace askap;
+using namespace askap::components;
+using namespace casacore;
+
+namespace {
+
+const char MAGIC[8] = {'A', 'S', 'K', 'A', 'P', 'C', 'A', 'T'};
+const uint32_t VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/// The header of a catalogue file, which is followed by the columns
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t nRows;
+    uint32_t directionType;
+    uint32_t padding;
+};
+
+/// The number of double columns, and the bytes per component
+const size_t N_DOUBLE_COLUMNS = 12;
+const size_t ROW_BYTES = N_DOUBLE_COLUMNS * sizeof(double) + sizeof(int32_t);
+
+/// Write one double column, built from a member of each row
+template <class Getter>
+void writeColumn(std::ofstream& out, const std::vector<ComponentCatalogue::Row>& rows,
+                 std::vector<double>& column, Getter get)
+{
+    column.resize(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        column[i] = get(rows[i]);
+    }
+    out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(double));
+}
+
+}
+
+ComponentCatalogue::Row::Row() : ra(0.0), dec(0.0), shape(casacore::ComponentType::POINT),
+    majorAxis(0.0), minorAxis(0.0), positionAngle(0.0), refFrequency(0.0),
+    spectralIndex(0.0), spectralCurvature(0.0)
+{
+    for (uInt pol = 0; pol < 4; ++pol) {
+        flux[pol] = 0.0;
+    }
+}
+
+ComponentCatalogue::ComponentCatalogue(const std::string& filename)
+    : itsData(0), itsSize(0), itsN(0), itsDirectionType(MDirection::J2000)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    ASKAPCHECK(fd >= 0, "Failed to open component catalogue " << filename);
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+        close(fd);
+        ASKAPTHROW(AskapError, "Component catalogue " << filename << " has no header");
+    }
+    itsSize = info.st_size;
+    itsData = mmap(0, itsSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (itsData == MAP_FAILED) {
+        itsData = 0;
+        ASKAPTHROW(AskapError, "Failed to map component catalogue " << filename);
+    }
+
+    // Check the header before any column is used, and unmap the file if
+    // it is not a catalogue we can read
+    const Header& header = *static_cast<const Header*>(itsData);
+    const char* error = 0;
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "is not a component catalogue";
+    } else if (header.byteOrder != BYTE_ORDER_MARK) {
+        error = "has a different byte order";
+    } else if (header.version != VERSION) {
+        error = "has an unsupported version";
+    } else if (header.nRows > std::numeric_limits<uInt>::max()) {
+        error = "has too many components";
+    } else if (itsSize != sizeof(Header) + header.nRows * ROW_BYTES) {
+        error = "has the wrong size";
+    }
+    if (error) {
+        munmap(itsData, itsSize);
+        itsData = 0;
+        ASKAPTHROW(AskapError, "Component catalogue " << filename << " " << error);
+    }
+
+    itsN = header.nRows;
+    itsDirectionType = static_cast<MDirection::Types>(header.directionType);
+    const double* column = reinterpret_cast<const double*>(static_cast<const char*>(itsData)
+                                                           + sizeof(Header));
+    itsRa = column;
+    itsDec = (column += itsN);
+    itsMajorAxis = (column += itsN);
+    itsMinorAxis = (column += itsN);
+    itsPositionAngle = (column += itsN);
+    for (uInt pol = 0; pol < 4; ++pol) {
+        itsFlux[pol] = (column += itsN);
+    }
+    itsRefFrequency = (column += itsN);
+    itsSpectralIndex = (column += itsN);
+    itsSpectralCurvature = (column += itsN);
+    itsShape = reinterpret_cast<const int32_t*>(column + itsN);
+}
+
+ComponentCatalogue::~ComponentCatalogue()
+{
+    if (itsData) {
+        munmap(itsData, itsSize);
+    }
+}
+
+const double* ComponentCatalogue::flux(const casacore::Stokes::StokesTypes stokes) const
+{
+    switch (stokes) {
+        case Stokes::I:
+            return itsFlux[0];
+        case Stokes::Q:
+            return itsFlux[1];
+        case Stokes::U:
+            return itsFlux[2];
+        case Stokes::V:
+            return itsFlux[3];
+        default:
+            ASKAPTHROW(AskapError, "Only I, Q, U or V pols are supported");
+    }
+}
+
+void ComponentCatalogue::write(const std::string& filename, const std::vector<Row>& rows,
+                               const casacore::MDirection::Types frame)
+{
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    ASKAPCHECK(out, "Failed to create component catalogue " << filename);
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.nRows = rows.size();
+    header.directionType = frame;
+    header.padding = 0;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<double> column;
+    writeColumn(out, rows, column, [](const Row& r) { return r.ra; });
+    writeColumn(out, rows, column, [](const Row& r) { return r.dec; });
+    writeColumn(out, rows, column, [](const Row& r) { return r.majorAxis; });
+    writeColumn(out, rows, column, [](const Row& r) { return r.minorAxis; });
+    writeColumn(out, rows, column, [](const Row& r) { return r.positionAngle; });
+    for (uInt pol = 0; pol < 4; ++pol) {
+        writeColumn(out, rows, column, [pol](const Row& r) { return r.flux[pol]; });
+    }
+    writeColumn(out, rows, column, [](const Row& r) { return r.refFrequency; });
+    writeColumn(out, rows, column, [](const Row& r) { return r.spectralIndex; });
+    writeColumn(out, rows, column, [](const Row& r) { return r.spectralCurvature; });
+
+    std::vector<int32_t> shapes(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        shapes[i] = rows[i].shape;
+    }
+    out.write(reinterpret_cast<const char*>(shapes.data()), shapes.size() * sizeof(int32_t));
+    out.close();
+    ASKAPCHECK(out, "Failed to write component catalogue " << filename);
+}
+
+void ComponentCatalogue::write(const std::string& filename, const casacore::ComponentList& list)
+{
+    // The flux table reduces every supported spectrum to the form stored
+    const ComponentFluxTable fluxTable(list);
+    const MDirection::Types frame = (list.nelements() > 0)
+        ? static_cast<MDirection::Types>(list.component(0).shape().refDirection().getRef().getType())
+        : MDirection::J2000;
+
+    std::vector<Row> rows(list.nelements());
+    for (uInt i = 0; i < list.nelements(); ++i) {
+        const ComponentShape& shape = list.component(i).shape();
+        const MDirection& dir = shape.refDirection();
+        ASKAPCHECK(dir.getRef().getType() == frame,
+                   "All components must have the same direction reference frame");
+        Row& row = rows[i];
+        row.ra = dir.getValue().getLong();
+        row.dec = dir.getValue().getLat();
+        row.shape = shape.type();
+        switch (row.shape) {
+            case casacore::ComponentType::POINT:
+                break;
+
+            case casacore::ComponentType::GAUSSIAN:
+            case casacore::ComponentType::DISK: {
+                const TwoSidedShape& twoSided = dynamic_cast<const TwoSidedShape&>(shape);
+                row.majorAxis = twoSided.majorAxisInRad();
+                row.minorAxis = twoSided.minorAxisInRad();
+                row.positionAngle = twoSided.positionAngleInRad();
+                break;
+            }
+
+            default:
+                ASKAPTHROW(AskapError, "Unsupported shape type");
+        }
+        row.flux[0] = fluxTable.flux(i, Stokes::I);
+        row.flux[1] = fluxTable.flux(i, Stokes::Q);
+        row.flux[2] = fluxTable.flux(i, Stokes::U);
+        row.flux[3] = fluxTable.flux(i, Stokes::V);
+        row.refFrequency = fluxTable.refFrequency(i);
+        row.spectralIndex = fluxTable.alpha(i);
+        row.spectralCurvature = fluxTable.beta(i);
+    }
+    write(filename, rows, frame);
+}
@@ -0,0 +1,197 @@
+/// @file ComponentCatalogue.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_COMPONENTCATALOGUE_H
+#define ASKAP_COMPONENTS_COMPONENTCATALOGUE_H
+
+// System includes
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+#include "casacore/measures/Measures/MDirection.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "casarest/components/ComponentModels/ComponentList.h"
+#include "casarest/components/ComponentModels/ComponentType.h"
+
+namespace askap {
+namespace components {
+
+/// @brief A read-only component catalogue, stored one column per parameter
+/// in a binary file which is memory mapped.
+///
+/// Building a casacore::ComponentList of millions of components (each with
+/// its own heap allocated shape, spectrum and flux) can take longer than the
+/// projection itself. A catalogue instead maps its file, so opening one only
+/// reads the header, and the columns are read directly from the page cache
+/// as they are used. AskapComponentImager::project() accepts a catalogue in
+/// place of a list.
+///
+/// The file is a 32 byte header followed by the columns, each with one
+/// element per component in native byte order:
+/// \li the header, which is the magic string "ASKAPCAT", the format version
+///      (uint32), the byte order mark 0x01020304 (uint32), the number of
+///      components (uint64), the casacore::MDirection::Types of the directions
+///      (uint32) and four bytes of padding
+/// \li the right ascension and declination, in radians (double)
+/// \li the major axis, minor axis and position angle, in radians (double).
+///      These are zero for a point.
+/// \li the Stokes I, Q, U and V flux at the reference frequency, in Jy (double)
+/// \li the reference frequency in Hz, in the LSRK frame, which is zero for a
+///      flat spectrum (double)
+/// \li the spectral index and curvature (double)
+/// \li the casacore::ComponentType::Shape (int32)
+///
+/// The spectrum is (nu / nu0)^(alpha + beta * ln(nu / nu0)) as for a
+/// ComponentFluxTable, so every spectral model supported by the imager can
+/// be stored.
+///
+/// Thread Safety:
+/// A catalogue is not modified after it is opened, so it may be shared
+/// between threads.
+class ComponentCatalogue {
+    public:
+        /// One component, as written to a catalogue
+        struct Row {
+            /// Constructor
+            /// Creates an unpolarised point with a flat spectrum, and
+            /// no flux
+            Row();
+
+            double ra;
+            double dec;
+            casacore::ComponentType::Shape shape;
+            double majorAxis;
+            double minorAxis;
+            double positionAngle;
+            double flux[4];
+            double refFrequency;
+            double spectralIndex;
+            double spectralCurvature;
+        };
+
+        /// Constructor
+        /// Maps a catalogue file.
+        ///
+        /// @param[in] filename the name of the file.
+        /// @throw AskapError   if the file cannot be mapped, or is not a
+        ///                     catalogue of this version and byte order.
+        explicit ComponentCatalogue(const std::string& filename);
+
+        /// Destructor
+        /// Unmaps the file.
+        ~ComponentCatalogue();
+
+        /// Write a catalogue file.
+        ///
+        /// @param[in] filename the name of the file, which is replaced if it exists.
+        /// @param[in] rows     the components.
+        /// @param[in] frame    the reference frame of the directions.
+        /// @throw AskapError   if the file cannot be written.
+        static void write(const std::string& filename, const std::vector<Row>& rows,
+                          const casacore::MDirection::Types frame = casacore::MDirection::J2000);
+
+        /// Write a catalogue file holding a component list.
+        ///
+        /// @param[in] filename the name of the file, which is replaced if it exists.
+        /// @param[in] list     the components, which must share a direction
+        ///                     reference frame.
+        /// @throw AskapError   if a component has an unsupported shape or
+        ///                     spectral model, or the file cannot be written.
+        static void write(const std::string& filename, const casacore::ComponentList& list);
+
+        /// @return the number of components
+        casacore::uInt nelements(void) const { return itsN; }
+
+        /// @return the reference frame of the directions
+        casacore::MDirection::Types directionType(void) const { return itsDirectionType; }
+
+        /// @return the shape of component i
+        casacore::ComponentType::Shape shape(const casacore::uInt i) const
+        {
+            return static_cast<casacore::ComponentType::Shape>(itsShape[i]);
+        }
+
+        /// @return the right ascension of each component, in radians
+        const double* ra(void) const { return itsRa; }
+
+        /// @return the declination of each component, in radians
+        const double* dec(void) const { return itsDec; }
+
+        /// @return the major axis of each component, in radians
+        const double* majorAxis(void) const { return itsMajorAxis; }
+
+        /// @return the minor axis of each component, in radians
+        const double* minorAxis(void) const { return itsMinorAxis; }
+
+        /// @return the position angle of each component, in radians
+        const double* positionAngle(void) const { return itsPositionAngle; }
+
+        /// @param[in] stokes   the polarisation, which must be one of I, Q, U or V.
+        /// @return the flux of each component at its reference frequency, in Jy
+        const double* flux(const casacore::Stokes::StokesTypes stokes) const;
+
+        /// @return the reference frequency of each component, in Hz
+        const double* refFrequency(void) const { return itsRefFrequency; }
+
+        /// @return the spectral index of each component
+        const double* spectralIndex(void) const { return itsSpectralIndex; }
+
+        /// @return the spectral curvature of each component
+        const double* spectralCurvature(void) const { return itsSpectralCurvature; }
+
+    private:
+        // No support for assignment or copying
+        ComponentCatalogue& operator=(const ComponentCatalogue& rhs);
+        ComponentCatalogue(const ComponentCatalogue& src);
+
+        // The mapping of the file
+        void* itsData;
+        size_t itsSize;
+
+        casacore::uInt itsN;
+        casacore::MDirection::Types itsDirectionType;
+
+        // The columns, which point into the mapping
+        const double* itsRa;
+        const double* itsDec;
+        const double* itsMajorAxis;
+        const double* itsMinorAxis;
+        const double* itsPositionAngle;
+        const double* itsFlux[4];
+        const double* itsRefFrequency;
+        const double* itsSpectralIndex;
+        const double* itsSpectralCurvature;
+        const int32_t* itsShape;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,253 @@
+/// @file ComponentFluxTable.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "ComponentFluxTable.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "casacore/measures/Measures/MFrequency.h"
+#include "components/ComponentModels/SkyComponent.h"
+#include "components/ComponentModels/ComponentList.h"
+#include "components/ComponentModels/Flux.h"
+#include "components/ComponentModels/SpectralIndex.h"
+#include "components/ComponentModels/SpectralModel.h"
+#include "components/ComponentModels/ComponentType.h"
+
+// Local package includes
+#include "ComponentCatalogue.h"
+#include "ComponentType.h"
+#include "SpectralModel.h"
+#include "SpectralIndex.h"
+#include "CurvedSpectrum.h"
+
+using namespace askap;
+using namespace askap::components;
+using namespace casacore;
+
+ComponentFluxTable::ComponentFluxTable(const casacore::ComponentList& list)
+{
+    std::vector<uInt> indices(list.nelements());
+    for (uInt i = 0; i < list.nelements(); ++i) {
+        indices[i] = i;
+    }
+    init(list, indices, 0);
+}
+
+ComponentFluxTable::ComponentFluxTable(const casacore::ComponentList& list,
+                                       const std::vector<casacore::uInt>& indices)
+{
+    init(list, indices, 0);
+}
+
+ComponentFluxTable::ComponentFluxTable(const casacore::ComponentList& list,
+        const std::vector<casacore::uInt>& indices,
+        const std::vector<const askap::components::SpectralModel*>& models)
+{
+    ASKAPCHECK(models.size() == list.nelements(),
+               "There must be one spectral model entry per component");
+    init(list, indices, &models);
+}
+
+ComponentFluxTable::ComponentFluxTable(const ComponentCatalogue& catalogue,
+                                       const std::vector<casacore::uInt>& indices)
+{
+    const size_t n = indices.size();
+    itsI.resize(n);
+    itsQ.resize(n);
+    itsU.resize(n);
+    itsV.resize(n);
+    itsAlpha.resize(n);
+    itsBeta.resize(n);
+    itsRefFreq.resize(n);
+    itsLogRefFreq.resize(n);
+
+    const double* fluxI = catalogue.flux(Stokes::I);
+    const double* fluxQ = catalogue.flux(Stokes::Q);
+    const double* fluxU = catalogue.flux(Stokes::U);
+    const double* fluxV = catalogue.flux(Stokes::V);
+    for (uInt i = 0; i < n; ++i) {
+        const uInt c = indices[i];
+        ASKAPCHECK(c < catalogue.nelements(), "Component index out of range");
+        itsI[i] = fluxI[c];
+        itsQ[i] = fluxQ[c];
+        itsU[i] = fluxU[c];
+        itsV[i] = fluxV[c];
+        itsAlpha[i] = catalogue.spectralIndex()[c];
+        itsBeta[i] = catalogue.spectralCurvature()[c];
+        itsRefFreq[i] = catalogue.refFrequency()[c];
+        if (itsAlpha[i] != 0.0 || itsBeta[i] != 0.0) {
+            ASKAPCHECK(itsRefFreq[i] > 0.0, "Reference frequency must be positive");
+        }
+        itsLogRefFreq[i] = (itsRefFreq[i] > 0.0) ? log(itsRefFreq[i]) : 0.0;
+    }
+}
+
+void ComponentFluxTable::init(const casacore::ComponentList& list,
+        const std::vector<casacore::uInt>& indices,
+        const std::vector<const askap::components::SpectralModel*>* models)
+{
+    const size_t n = indices.size();
+    itsI.resize(n);
+    itsQ.resize(n);
+    itsU.resize(n);
+    itsV.resize(n);
+    itsAlpha.assign(n, 0.0);
+    itsBeta.assign(n, 0.0);
+    itsRefFreq.assign(n, 0.0);
+    itsLogRefFreq.assign(n, 0.0);
+
+    for (uInt i = 0; i < n; ++i) {
+        ASKAPCHECK(indices[i] < list.nelements(), "Component index out of range");
+        const SkyComponent& c = list.component(indices[i]);
+
+        // A Flux converts its representation in place, so work on a copy
+        Flux<Double> flux = c.flux().copy();
+        itsI[i] = flux.value(Stokes::I, true).getValue("Jy");
+        itsQ[i] = flux.value(Stokes::Q, true).getValue("Jy");
+        itsU[i] = flux.value(Stokes::U, true).getValue("Jy");
+        itsV[i] = flux.value(Stokes::V, true).getValue("Jy");
+
+        // A supplied spectral model replaces that of the component
+        const askap::components::SpectralModel* model =
+            models ? (*models)[indices[i]] : 0;
+        if (model) {
+            switch (model->type()) {
+                case askap::components::ComponentType::CONSTANT_SPECTRUM:
+                    break;
+
+                case askap::components::ComponentType::SPECTRAL_INDEX: {
+                    const askap::components::SpectralIndex& m =
+                        dynamic_cast<const askap::components::SpectralIndex&>(*model);
+                    itsAlpha[i] = m.getIndex();
+                    setRefFrequency(i, m.getRefFreq());
+                    break;
+                }
+
+                case askap::components::ComponentType::CURVED_SPECTRUM: {
+                    const CurvedSpectrum& m = dynamic_cast<const CurvedSpectrum&>(*model);
+                    itsAlpha[i] = m.getIndex();
+                    itsBeta[i] = m.getCurvature();
+                    setRefFrequency(i, m.getRefFreq());
+                    break;
+                }
+
+                default:
+                    ASKAPTHROW(AskapError, "Unsupported spectral model");
+            }
+            continue;
+        }
+
+        const casacore::ComponentType::SpectralShape type = c.spectrum().type();
+        if (type == casacore::ComponentType::CONSTANT_SPECTRUM) {
+            // Already set: alpha = 0 gives a scale of exactly one
+        } else if (type == casacore::ComponentType::SPECTRAL_INDEX) {
+            const casacore::SpectralIndex& model =
+                dynamic_cast<const casacore::SpectralIndex&>(c.spectrum());
+            itsAlpha[i] = model.index();
+            setRefFrequency(i, model.refFrequency());
+        } else {
+            ASKAPTHROW(AskapError, "Unsupported spectral model");
+        }
+    }
+}
+
+void ComponentFluxTable::setRefFrequency(const casacore::uInt i,
+                                         const casacore::MFrequency& refFreq)
+{
+    // The channel frequencies are in the default (LSRK) frame, so as
+    // for SpectralIndex::sample() the reference frequency is
+    // converted to that frame
+    MFrequency converted = refFreq;
+    if (converted.getRef().getType() != MFrequency::DEFAULT) {
+        converted = MFrequency::Convert(refFreq, MFrequency::Ref(MFrequency::DEFAULT))();
+    }
+    const double refFreqHz = converted.getValue().getValue();
+    ASKAPCHECK(refFreqHz > 0.0, "Reference frequency must be positive");
+    itsRefFreq[i] = refFreqHz;
+    itsLogRefFreq[i] = log(refFreqHz);
+}
+
+double ComponentFluxTable::flux(const casacore::uInt i,
+                                const casacore::Stokes::StokesTypes stokes) const
+{
+    switch (stokes) {
+        case Stokes::I:
+            return itsI[i];
+        case Stokes::Q:
+            return itsQ[i];
+        case Stokes::U:
+            return itsU[i];
+        case Stokes::V:
+            return itsV[i];
+        default:
+            ASKAPTHROW(AskapError, "Only I, Q, U or V pols are supported");
+    }
+}
+
+double ComponentFluxTable::taylorFactor(const casacore::uInt i, const unsigned int term) const
+{
+    const double alpha = itsAlpha[i];
+    switch (term) {
+        case 0:
+            return 1.0;
+        case 1:
+            return alpha;
+        case 2:
+            return 0.5 * alpha * (alpha - 1.0) + itsBeta[i];
+        default:
+            ASKAPTHROW(AskapError, "Only support taylor terms 0, 1 & 2");
+    }
+}
+
+void ComponentFluxTable::spectralScale(const casacore::uInt i,
+                                       const std::vector<double>& logFreqs,
+                                       double* scale) const
+{
+    const double alpha = itsAlpha[i];
+    const double beta = itsBeta[i];
+    const double logRefFreq = itsLogRefFreq[i];
+    const size_t nFreqs = logFreqs.size();
+    if (alpha == 0.0 && beta == 0.0) {
+        std::fill(scale, scale + nFreqs, 1.0);
+        return;
+    }
+    const double* lf = logFreqs.empty() ? 0 : &logFreqs[0];
+    for (size_t f = 0; f < nFreqs; ++f) {
+        const double logRatio = lf[f] - logRefFreq;
+        scale[f] = exp((alpha + beta * logRatio) * logRatio);
+    }
+}
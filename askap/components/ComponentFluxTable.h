@@ -0,0 +1,197 @@
+/// @file ComponentFluxTable.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_COMPONENTFLUXTABLE_H
+#define ASKAP_COMPONENTS_COMPONENTFLUXTABLE_H
+
+// System includes
+#include <vector>
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "casarest/components/ComponentModels/ComponentList.h"
+#include "casacore/measures/Measures/MFrequency.h"
+
+// Local package includes
+#include "SpectralModel.h"
+
+namespace askap {
+namespace components {
+
+class ComponentCatalogue;
+
+/// @brief The flux and spectral parameters of every component in a list,
+/// stored as one flat array per parameter.
+///
+/// The table is built once per component list, and replaces the per channel
+/// copying of the casacore Flux object, the spectral model sample() and the
+/// dynamic_cast needed for the taylor terms. Each spectrum is reduced to
+///     S(nu) = S0 * (nu / nu0)^(alpha + beta * ln(nu / nu0))
+/// where a constant spectrum has alpha = beta = 0, so the spectral scale for
+/// all channels of a component is a single pass over the channel log
+/// frequencies.
+///
+/// The spectrum of a component is taken from its casacore spectral model,
+/// unless an askap::components::SpectralModel is supplied for it. This allows
+/// spectral models without a casacore equivalent, such as CurvedSpectrum.
+class ComponentFluxTable {
+    public:
+        /// The forms of the spectral scale factor
+        enum SpectralKind {
+            /// The scale is one at all frequencies (alpha = beta = 0)
+            FLAT,
+
+            /// A power law, (nu / nu0)^alpha (beta = 0)
+            POWER_LAW,
+
+            /// A curved power law, (nu / nu0)^(alpha + beta * ln(nu / nu0))
+            CURVED
+        };
+
+        /// Constructor
+        ///
+        /// @param[in] list     the component list.
+        /// @throw AskapError   if a component has an unsupported spectral model.
+        explicit ComponentFluxTable(const casacore::ComponentList& list);
+
+        /// Constructor
+        /// Builds the table for a subset of the list, where row i of the
+        /// table is component indices[i] of the list.
+        ///
+        /// @param[in] list     the component list.
+        /// @param[in] indices  the indices of the components to include.
+        /// @throw AskapError   if a component has an unsupported spectral
+        ///                     model, or an index is out of range.
+        ComponentFluxTable(const casacore::ComponentList& list,
+                           const std::vector<casacore::uInt>& indices);
+
+        /// Constructor
+        /// Builds the table for a subset of the list, where row i of the
+        /// table is component indices[i] of the list, and where the spectrum
+        /// of component j of the list is models[j] if that is not null.
+        ///
+        /// @param[in] list     the component list.
+        /// @param[in] indices  the indices of the components to include.
+        /// @param[in] models   the spectral models which replace those of the
+        ///                     list, with one (possibly null) entry per component.
+        /// @throw AskapError   if a component has an unsupported spectral
+        ///                     model, or an index is out of range.
+        ComponentFluxTable(const casacore::ComponentList& list,
+                           const std::vector<casacore::uInt>& indices,
+                           const std::vector<const SpectralModel*>& models);
+
+        /// Constructor
+        /// Builds the table for a subset of a catalogue, where row i of the
+        /// table is component indices[i] of the catalogue. The columns are
+        /// copied as they are, since they already hold the reduced spectrum.
+        ///
+        /// @param[in] catalogue    the component catalogue.
+        /// @param[in] indices      the indices of the components to include.
+        /// @throw AskapError   if an index is out of range, or a component
+        ///                     with a spectral index has no reference frequency.
+        ComponentFluxTable(const ComponentCatalogue& catalogue,
+                           const std::vector<casacore::uInt>& indices);
+
+        /// @return the number of components (rows) in the table
+        casacore::uInt nelements(void) const { return itsAlpha.size(); }
+
+        /// @param[in] i        the component index.
+        /// @param[in] stokes   the polarisation, which must be one of I, Q, U or V.
+        /// @return the flux, in Jy, at the reference frequency.
+        double flux(const casacore::uInt i, const casacore::Stokes::StokesTypes stokes) const;
+
+        /// @return the spectral index of component i
+        double alpha(const casacore::uInt i) const { return itsAlpha[i]; }
+
+        /// @return the spectral curvature of component i
+        double beta(const casacore::uInt i) const { return itsBeta[i]; }
+
+        /// @return the reference frequency, in Hz, of component i, or zero
+        ///         for a constant spectrum
+        double refFrequency(const casacore::uInt i) const { return itsRefFreq[i]; }
+
+        /// @return the natural log of the reference frequency, in Hz, of
+        ///         component i, or zero for a constant spectrum
+        double logRefFrequency(const casacore::uInt i) const { return itsLogRefFreq[i]; }
+
+        /// @return the form of the spectral scale factor of component i
+        SpectralKind spectralKind(const casacore::uInt i) const
+        {
+            if (itsBeta[i] != 0.0) {
+                return CURVED;
+            }
+            return (itsAlpha[i] != 0.0) ? POWER_LAW : FLAT;
+        }
+
+        /// The factor which converts the flux at the reference frequency to
+        /// the given taylor term:
+        ///     I0 = I(v0)
+        ///     I1 = I(v0) * alpha
+        ///     I2 = I(v0) * (0.5 * alpha * (alpha - 1) + beta)
+        ///
+        /// @param[in] i        the component index.
+        /// @param[in] term     the taylor term.
+        /// @throw AskapError   if the term is not 0, 1 or 2.
+        double taylorFactor(const casacore::uInt i, const unsigned int term) const;
+
+        /// Calculate the spectral scale factor,
+        /// (nu / nu0)^(alpha + beta * ln(nu / nu0)), of a component for a set
+        /// of channels.
+        ///
+        /// @param[in] i            the component index.
+        /// @param[in] logFreqs     the natural log of each channel frequency in Hz.
+        /// @param[out] scale       the scale for each channel, with the same
+        ///                         number of elements as logFreqs.
+        void spectralScale(const casacore::uInt i, const std::vector<double>& logFreqs,
+                           double* scale) const;
+
+    private:
+        // Fill the table from the given components of the list
+        void init(const casacore::ComponentList& list,
+                  const std::vector<casacore::uInt>& indices,
+                  const std::vector<const SpectralModel*>* models);
+
+        // Set the reference frequency of row i
+        void setRefFrequency(const casacore::uInt i, const casacore::MFrequency& refFreq);
+
+        // Flux at the reference frequency, in Jy
+        std::vector<double> itsI;
+        std::vector<double> itsQ;
+        std::vector<double> itsU;
+        std::vector<double> itsV;
+
+        // Spectral parameters
+        std::vector<double> itsAlpha;
+        std::vector<double> itsBeta;
+        std::vector<double> itsRefFreq;
+        std::vector<double> itsLogRefFreq;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,123 @@
+/// @file ComponentFootprint.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_COMPONENTFOOTPRINT_H
+#define ASKAP_COMPONENTS_COMPONENTFOOTPRINT_H
+
+// System includes
+#include <vector>
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+
+namespace askap {
+namespace components {
+
+/// @brief The pixel footprint of a single component, for unit flux.
+///
+/// The footprint is the (inclusive) bounding box of pixels on the direction
+/// axes which the component contributes to, along with the contribution to
+/// each of those pixels for a component of flux 1 Jy. It does not depend on
+/// frequency or polarisation, so it can be calculated once per component and
+/// then scaled by the flux for each image plane.
+///
+/// The values are indexed (lat - startLat(), lon - startLon()), and are
+/// stored contiguously with the latitude axis varying fastest. The storage
+/// is kept when the footprint is resized, so a footprint which is reused for
+/// a sequence of components only allocates when it grows.
+class ComponentFootprint {
+    public:
+        /// Constructor
+        /// Creates an empty footprint
+        ComponentFootprint() : itsStartLat(0), itsStartLon(0), itsNLat(0), itsNLon(0) {}
+
+        /// @return the first pixel on the latitude axis
+        int startLat(void) const { return itsStartLat; }
+
+        /// @return the first pixel on the longitude axis
+        int startLon(void) const { return itsStartLon; }
+
+        /// @return the number of pixels on the latitude axis
+        casacore::uInt nLat(void) const { return itsNLat; }
+
+        /// @return the number of pixels on the longitude axis
+        casacore::uInt nLon(void) const { return itsNLon; }
+
+        /// @return true if the footprint covers no pixels
+        bool empty(void) const { return itsNLat == 0 || itsNLon == 0; }
+
+        /// Resize the footprint to cover the given (inclusive) pixel ranges.
+        /// All values are reset to zero.
+        void resize(const int startLat, const int endLat,
+                    const int startLon, const int endLon)
+        {
+            itsStartLat = startLat;
+            itsStartLon = startLon;
+            itsNLat = endLat - startLat + 1;
+            itsNLon = endLon - startLon + 1;
+            itsValues.assign(static_cast<size_t>(itsNLat) * itsNLon, 0.0);
+        }
+
+        /// Move the footprint so its first pixel is (startLat, startLon),
+        /// keeping its size and values.
+        void move(const int startLat, const int startLon)
+        {
+            itsStartLat = startLat;
+            itsStartLon = startLon;
+        }
+
+        /// @return the unit flux value of pixel (x, y) of the footprint
+        double operator()(const casacore::uInt x, const casacore::uInt y) const
+        {
+            return itsValues[x + static_cast<size_t>(y) * itsNLat];
+        }
+
+        /// @return the unit flux value of pixel (x, y) of the footprint
+        double& operator()(const casacore::uInt x, const casacore::uInt y)
+        {
+            return itsValues[x + static_cast<size_t>(y) * itsNLat];
+        }
+
+        /// @return the unit flux values, where row y (along the latitude
+        ///         axis) starts at element y * nLat()
+        const double* data(void) const { return itsValues.empty() ? 0 : &itsValues[0]; }
+
+        /// @return the unit flux values, where row y (along the latitude
+        ///         axis) starts at element y * nLat()
+        double* data(void) { return itsValues.empty() ? 0 : &itsValues[0]; }
+
+    private:
+        int itsStartLat;
+        int itsStartLon;
+        casacore::uInt itsNLat;
+        casacore::uInt itsNLon;
+        std::vector<double> itsValues;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,235 @@
+/// @file ComponentIndex.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "ComponentIndex.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Quanta/MVDirection.h"
+#include "casacore/measures/Measures/MDirection.h"
+#include "casacore/measures/Measures/MCDirection.h"
+#include "casacore/coordinates/Coordinates/DirectionCoordinate.h"
+#include "components/ComponentModels/SkyComponent.h"
+#include "components/ComponentModels/ComponentList.h"
+#include "components/ComponentModels/ComponentShape.h"
+#include "components/ComponentModels/ComponentType.h"
+#include "components/ComponentModels/GaussianShape.h"
+#include "components/ComponentModels/DiskShape.h"
+
+using namespace askap;
+using namespace askap::components;
+using namespace casacore;
+
+namespace {
+
+/// @return the direction in the J2000 frame
+MVDirection toJ2000(const MDirection& dir)
+{
+    if (dir.getRef().getType() == MDirection::J2000) {
+        return dir.getValue();
+    }
+    return MDirection::Convert(dir, MDirection::Ref(MDirection::J2000))().getValue();
+}
+
+/// @return the chord length between unit vectors separated by an angle, or
+/// a length greater than any chord if the angle is at least pi
+double chord(const double angle)
+{
+    return (angle >= M_PI) ? 3.0 : 2.0 * sin(0.5 * angle);
+}
+
+}
+
+ComponentIndex::ComponentIndex(const casacore::ComponentList& list)
+    : itsXyz(3 * list.nelements()), itsSigma(list.nelements(), 0.0), itsMaxSigma(0.0),
+      itsRadius(list.nelements(), 0.0), itsMaxRadius(0.0)
+{
+    const double fwhmToSigma = 1. / (2. * M_SQRT2 * sqrt(M_LN2));
+    for (uInt i = 0; i < list.nelements(); ++i) {
+        const ComponentShape& shape = list.component(i).shape();
+        const MVDirection dir = toJ2000(shape.refDirection());
+        for (uInt axis = 0; axis < 3; ++axis) {
+            itsXyz[3 * i + axis] = dir(axis);
+        }
+
+        switch (shape.type()) {
+            case casacore::ComponentType::POINT:
+                itsOrder.push_back(i);
+                break;
+
+            case casacore::ComponentType::GAUSSIAN:
+                itsSigma[i] = dynamic_cast<const GaussianShape&>(shape).majorAxis() * fwhmToSigma;
+                itsMaxSigma = std::max(itsMaxSigma, itsSigma[i]);
+                itsOrder.push_back(i);
+                break;
+
+            case casacore::ComponentType::DISK:
+                itsRadius[i] = 0.5 * dynamic_cast<const DiskShape&>(shape).majorAxisInRad();
+                itsMaxRadius = std::max(itsMaxRadius, itsRadius[i]);
+                itsOrder.push_back(i);
+                break;
+
+            default:
+                itsSigma[i] = -1.0;
+                itsUnbounded.push_back(i);
+                break;
+        }
+    }
+    build(0, itsOrder.size(), 0);
+}
+
+void ComponentIndex::query(const casacore::MVDirection& centre, const double radius,
+                           const double nSigma, std::vector<casacore::uInt>& indices) const
+{
+    ASKAPCHECK(radius >= 0.0 && nSigma >= 0.0, "Search radius must not be negative");
+    indices = itsUnbounded;
+    const double point[3] = {centre(0), centre(1), centre(2)};
+    search(0, itsOrder.size(), 0, point, radius, nSigma,
+           chord(radius + nSigma * itsMaxSigma + itsMaxRadius), indices);
+
+    // Return the components in list order, so they are projected in the
+    // same order as they would be without the index
+    std::sort(indices.begin(), indices.end());
+}
+
+void ComponentIndex::query(const casacore::DirectionCoordinate& dirCoord,
+                           const casacore::uInt nLat, const casacore::uInt nLon,
+                           const double nSigma, std::vector<casacore::uInt>& indices) const
+{
+    ASKAPCHECK(nLat > 0 && nLon > 0, "Image must not be empty");
+
+    // The cone is centred on the centre of the image, and passes through
+    // the outer edge of the furthest edge pixel. The edges are sampled, and
+    // if any point cannot be converted to a world position (e.g. the image
+    // extends beyond the projection's horizon) no components are culled.
+    MDirection world;
+    Vector<Double> pixel(2);
+    pixel(0) = 0.5 * (nLat - 1.0);
+    pixel(1) = 0.5 * (nLon - 1.0);
+    double radius = M_PI;
+    if (dirCoord.toWorld(world, pixel)) {
+        const MVDirection centre = toJ2000(world);
+        const int nSamples = 16;
+        const double latEdge[2] = {-0.5, nLat - 0.5};
+        const double lonEdge[2] = {-0.5, nLon - 0.5};
+        bool ok = true;
+        radius = 0.0;
+        for (int side = 0; side < 2 && ok; ++side) {
+            for (int k = 0; k <= nSamples && ok; ++k) {
+                const double lat = -0.5 + nLat * static_cast<double>(k) / nSamples;
+                const double lon = -0.5 + nLon * static_cast<double>(k) / nSamples;
+
+                // Along the edges of constant latitude pixel, then longitude pixel
+                pixel(0) = latEdge[side];
+                pixel(1) = lon;
+                ok = ok && dirCoord.toWorld(world, pixel);
+                if (ok) {
+                    radius = std::max(radius, centre.separation(toJ2000(world)));
+                }
+                pixel(0) = lat;
+                pixel(1) = lonEdge[side];
+                ok = ok && dirCoord.toWorld(world, pixel);
+                if (ok) {
+                    radius = std::max(radius, centre.separation(toJ2000(world)));
+                }
+            }
+        }
+
+        // Pad by a pixel, for the rounding of positions to pixels
+        pixel(0) = 0.5 * (nLat - 1.0) + 1.0;
+        pixel(1) = 0.5 * (nLon - 1.0) + 1.0;
+        ok = ok && dirCoord.toWorld(world, pixel);
+        if (ok) {
+            radius += centre.separation(toJ2000(world));
+            query(centre, radius, nSigma, indices);
+            return;
+        }
+    }
+
+    // Cannot bound the image, so return every component
+    indices.resize(nelements());
+    for (uInt i = 0; i < nelements(); ++i) {
+        indices[i] = i;
+    }
+}
+
+void ComponentIndex::build(const size_t lo, const size_t hi, const unsigned int depth)
+{
+    if (hi <= lo + 1) {
+        return;
+    }
+
+    // Split at the median along one axis, which is held at the midpoint.
+    // Components before it are not above it along that axis, and those
+    // after it are not below it.
+    const size_t mid = lo + (hi - lo) / 2;
+    const unsigned int axis = depth % 3;
+    const std::vector<double>& xyz = itsXyz;
+    std::nth_element(itsOrder.begin() + lo, itsOrder.begin() + mid, itsOrder.begin() + hi,
+                     [&xyz, axis](uInt a, uInt b) { return xyz[3 * a + axis] < xyz[3 * b + axis]; });
+    build(lo, mid, depth + 1);
+    build(mid + 1, hi, depth + 1);
+}
+
+void ComponentIndex::search(const size_t lo, const size_t hi, const unsigned int depth,
+                            const double* point, const double radius, const double nSigma,
+                            const double maxChord, std::vector<casacore::uInt>& indices) const
+{
+    if (hi <= lo) {
+        return;
+    }
+
+    const size_t mid = lo + (hi - lo) / 2;
+    const uInt i = itsOrder[mid];
+    const double* xyz = &itsXyz[3 * i];
+    const double dx = point[0] - xyz[0];
+    const double dy = point[1] - xyz[1];
+    const double dz = point[2] - xyz[2];
+    const double limit = chord(radius + nSigma * itsSigma[i] + itsRadius[i]);
+    if (dx * dx + dy * dy + dz * dz <= limit * limit) {
+        indices.push_back(i);
+    }
+
+    const unsigned int axis = depth % 3;
+    const double diff = point[axis] - xyz[axis];
+    if (diff <= maxChord) {
+        search(lo, mid, depth + 1, point, radius, nSigma, maxChord, indices);
+    }
+    if (-diff <= maxChord) {
+        search(mid + 1, hi, depth + 1, point, radius, nSigma, maxChord, indices);
+    }
+}
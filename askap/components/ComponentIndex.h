@@ -0,0 +1,130 @@
+/// @file ComponentIndex.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_COMPONENTINDEX_H
+#define ASKAP_COMPONENTS_COMPONENTINDEX_H
+
+// System includes
+#include <vector>
+#include <cstddef>
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Quanta/MVDirection.h"
+#include "casacore/coordinates/Coordinates/DirectionCoordinate.h"
+#include "casarest/components/ComponentModels/ComponentList.h"
+
+namespace askap {
+namespace components {
+
+/// @brief A spatial index over the directions of the components in a list,
+/// used to find the components which may contribute to an image.
+///
+/// The directions are held as J2000 unit vectors in a k-d tree, so a cone
+/// search costs O(sqrt(N) + k) rather than O(N). The index is built once
+/// and can then be queried for any number of images, so an all sky
+/// catalogue can be projected onto many small images (for instance one per
+/// beam) without visiting every component for each image.
+///
+/// Each component is padded by its extent: nSigma times the major axis
+/// standard deviation for a gaussian, the semi-major axis for a disk, and
+/// nothing for a point. Components
+/// with a shape which is not understood by the index are always returned.
+///
+/// Thread Safety:
+/// Once constructed, the index can be queried from several threads at once.
+class ComponentIndex {
+    public:
+        /// Constructor
+        ///
+        /// @param[in] list     the component list to index.
+        explicit ComponentIndex(const casacore::ComponentList& list);
+
+        /// @return the number of components in the indexed list
+        casacore::uInt nelements(void) const { return itsSigma.size(); }
+
+        /// Find the components which may be within a cone.
+        ///
+        /// @param[in] centre   the centre of the cone, in the J2000 frame.
+        /// @param[in] radius   the radius of the cone, in radians.
+        /// @param[in] nSigma   the component padding, in standard deviations.
+        /// @param[out] indices the (list) indices of the components whose
+        ///                     padded extent overlaps the cone, in ascending
+        ///                     order.
+        void query(const casacore::MVDirection& centre, const double radius,
+                   const double nSigma, std::vector<casacore::uInt>& indices) const;
+
+        /// Find the components which may be on an image. The image's sky
+        /// footprint is bounded by a cone through its edge pixels, padded by
+        /// one pixel.
+        ///
+        /// @param[in] dirCoord the direction coordinate of the image.
+        /// @param[in] nLat     the number of pixels along the latitude axis.
+        /// @param[in] nLon     the number of pixels along the longitude axis.
+        /// @param[in] nSigma   the component padding, in standard deviations.
+        /// @param[out] indices the (list) indices of the components which
+        ///                     may contribute to the image, in ascending order.
+        void query(const casacore::DirectionCoordinate& dirCoord,
+                   const casacore::uInt nLat, const casacore::uInt nLon,
+                   const double nSigma, std::vector<casacore::uInt>& indices) const;
+
+    private:
+        // Build the tree for the components itsOrder[lo, hi)
+        void build(const size_t lo, const size_t hi, const unsigned int depth);
+
+        // Search the tree for the components itsOrder[lo, hi)
+        void search(const size_t lo, const size_t hi, const unsigned int depth,
+                    const double* point, const double radius, const double nSigma,
+                    const double maxChord, std::vector<casacore::uInt>& indices) const;
+
+        // Unit vectors, indexed (3 * i + axis) where i is the list index
+        std::vector<double> itsXyz;
+
+        // Standard deviation of the major axis of each component, in radians.
+        // This is negative for components which are always returned.
+        std::vector<double> itsSigma;
+
+        // The largest of itsSigma
+        double itsMaxSigma;
+
+        // Padding of each component which does not depend on nSigma (the
+        // semi-major axis of a disk), in radians
+        std::vector<double> itsRadius;
+
+        // The largest of itsRadius
+        double itsMaxRadius;
+
+        // The list indices of the components in the tree, in tree order
+        std::vector<casacore::uInt> itsOrder;
+
+        // The list indices of the components which are always returned
+        std::vector<casacore::uInt> itsUnbounded;
+};
+
+}
+}
+
+#endif
@@ -40,7 +40,10 @@ class ComponentType {
             POINT,
 
             /// A gaussian shape
-            GAUSSIAN
+            GAUSSIAN,
+
+            /// An elliptical disk of uniform brightness
+            DISK
         };
 
         /// The available spectral variation models
@@ -50,7 +53,12 @@ class ComponentType {
 
             /// A flux model that models the spectral variation (as the
             /// frequency varies)with a spectral index
-            SPECTRAL_INDEX
+            SPECTRAL_INDEX,
+
+            /// A flux model that models the spectral variation with a
+            /// spectral index and a spectral curvature, i.e. a polynomial
+            /// in log frequency
+            CURVED_SPECTRUM
         };
 };
 
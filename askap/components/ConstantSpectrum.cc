@@ -30,10 +30,26 @@
 // Include package level header file
 #include "askap_components.h"
 
+// System includes
+#include <algorithm>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+
 using namespace askap;
 using namespace askap::components;
 
-ComponentType::SpectralShape ConstantSpectrum::type(void)
+ComponentType::SpectralShape ConstantSpectrum::type(void) const
 {
     return ComponentType::CONSTANT_SPECTRUM;
 }
+
+void ConstantSpectrum::sample(const double* frequencies, const size_t n, double* scale) const
+{
+    if (n == 0) {
+        return;
+    }
+    ASKAPCHECK(*std::min_element(frequencies, frequencies + n) > 0.0,
+            "User frequency is zero or negative");
+    std::fill(scale, scale + n, 1.0);
+}
@@ -42,7 +42,18 @@ class ConstantSpectrum : public SpectralModel {
     public:
 
         /// @return the type of the component
-        virtual ComponentType::SpectralShape type(void);
+        virtual ComponentType::SpectralShape type(void) const;
+
+        /// Sets the scaling factor to one for every frequency
+        ///
+        /// @param[in] frequencies  the frequencies, in Hz.
+        /// @param[in] n            the number of frequencies.
+        /// @param[out] scale       the scaling factor for each of the n
+        ///                         frequencies.
+        ///
+        /// @throws AskapError  if any frequency is zero or negative
+        virtual void sample(const double* frequencies, const size_t n,
+                            double* scale) const;
 };
 
 }
@@ -0,0 +1,100 @@
+/// @file CurvedSpectrum.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "CurvedSpectrum.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <cmath>
+#include <algorithm>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+
+// Local package includes
+#include "SpectralModel.h"
+#include "ComponentType.h"
+
+using namespace askap;
+using namespace askap::components;
+
+CurvedSpectrum::CurvedSpectrum(const casacore::MFrequency& refFreq,
+                               double index, double curvature)
+    : itsReferenceFreq(refFreq), itsSpectralIndex(index), itsSpectralCurvature(curvature)
+{
+    ASKAPCHECK(refFreq.get("Hz").getValue() > 0.0,
+            "Reference frequency is zero or negative");
+}
+
+ComponentType::SpectralShape CurvedSpectrum::type(void) const
+{
+    return ComponentType::CURVED_SPECTRUM;
+}
+
+double CurvedSpectrum::sample(const casacore::MFrequency& centerFrequency) const
+{
+    ASKAPCHECK(centerFrequency.type() == itsReferenceFreq.type(),
+            "User frequency and reference frequency have differing frames");
+    ASKAPCHECK(centerFrequency.get("Hz").getValue() > 0.0,
+            "User frequency is zero or negative");
+    const double logRatio = std::log(centerFrequency.get("Hz").getValue() /
+                                     itsReferenceFreq.get("Hz").getValue());
+    return std::exp((itsSpectralIndex + itsSpectralCurvature * logRatio) * logRatio);
+}
+
+void CurvedSpectrum::sample(const double* frequencies, const size_t n, double* scale) const
+{
+    if (n == 0) {
+        return;
+    }
+    ASKAPCHECK(*std::min_element(frequencies, frequencies + n) > 0.0,
+            "User frequency is zero or negative");
+    const double refFreq = itsReferenceFreq.get("Hz").getValue();
+    const double index = itsSpectralIndex;
+    const double curvature = itsSpectralCurvature;
+    for (size_t i = 0; i < n; ++i) {
+        const double logRatio = std::log(frequencies[i] / refFreq);
+        scale[i] = std::exp((index + curvature * logRatio) * logRatio);
+    }
+}
+
+const casacore::MFrequency& CurvedSpectrum::getRefFreq(void) const
+{
+    return itsReferenceFreq;
+}
+
+double CurvedSpectrum::getIndex(void) const
+{
+    return itsSpectralIndex;
+}
+
+double CurvedSpectrum::getCurvature(void) const
+{
+    return itsSpectralCurvature;
+}
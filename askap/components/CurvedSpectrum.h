@@ -0,0 +1,109 @@
+/// @file CurvedSpectrum.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_CURVEDSPECTRUM_H
+#define ASKAP_COMPONENTS_CURVEDSPECTRUM_H
+
+// ASKAPsoft includes
+#include "casacore/measures/Measures/MFrequency.h"
+
+// Local package includes
+#include "SpectralModel.h"
+#include "ComponentType.h"
+
+namespace askap {
+namespace components {
+
+/// A flux model that models the spectral variation (as the frequency varies)
+/// with a spectral index and a spectral curvature:
+///     S(nu) = S(nu0) * (nu / nu0)^(alpha + beta * ln(nu / nu0))
+///
+/// Thread Safety:
+/// While this class is immutable, it encapsulates an instance of casacore::MFrequency
+/// that is not known to be thread safe.
+class CurvedSpectrum : public SpectralModel {
+    public:
+
+        /// Constructor
+        ///
+        /// @param[in] refFreq      the reference frequency
+        /// @param[in] index        the spectral index (alpha)
+        /// @param[in] curvature    the spectral curvature (beta)
+        ///
+        /// @throws AskapError  if the "refFreq" parameter is zero or
+        ///                     negative
+        CurvedSpectrum(const casacore::MFrequency& refFreq, double index, double curvature);
+
+        /// Returns the type of the component
+        virtual ComponentType::SpectralShape type(void) const;
+
+        /// Returns Return the scaling factor that indicates what proportion of
+        /// the flux is at the specified frequency
+        ///
+        /// @param[in] centerFrequency  the frequency at which the flux scaling
+        ///                             value is requested.
+        ///
+        /// @throws AskapError  if the "centerFrequency" parameter has a different
+        ///                     reference frame to the reference frequency (as is
+        ///                     returned by getRef())
+        /// @throws AskapError  if the "centerFrequency" parameter is zero or
+        ///                     negative
+        virtual double sample(const casacore::MFrequency& centerFrequency) const;
+
+        /// Returns the scaling factor for a set of frequencies, which are
+        /// validated once and then evaluated in a loop the compiler can
+        /// vectorise.
+        ///
+        /// @param[in] frequencies  the frequencies, in Hz, which must already be
+        ///                         in the reference frame of the reference
+        ///                         frequency.
+        /// @param[in] n            the number of frequencies.
+        /// @param[out] scale       the scaling factor for each of the n
+        ///                         frequencies.
+        ///
+        /// @throws AskapError  if any frequency is zero or negative
+        virtual void sample(const double* frequencies, const size_t n,
+                            double* scale) const;
+
+        /// Returns the reference frequency
+        virtual const casacore::MFrequency& getRefFreq(void) const;
+
+        /// Returns the spectral index (alpha) value
+        virtual double getIndex(void) const;
+
+        /// Returns the spectral curvature (beta) value
+        virtual double getCurvature(void) const;
+
+    private:
+        const casacore::MFrequency itsReferenceFreq;
+        const double itsSpectralIndex;
+        const double itsSpectralCurvature;
+};
+
+}
+}
+
+#endif
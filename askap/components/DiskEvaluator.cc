@@ -0,0 +1,158 @@
+/// @file DiskEvaluator.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "DiskEvaluator.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <cmath>
+#include <algorithm>
+
+using namespace askap;
+using namespace askap::components;
+
+namespace {
+
+/// Axes are widened to at least this many pixels
+const double MIN_AXIS = 1.e-3;
+
+/// @return the signed area of the intersection of the unit circle with the
+/// triangle formed by the origin, a and b. The segment from a to b is split
+/// where it crosses the circle; the parts inside contribute a triangle and
+/// the parts outside a circular sector.
+double triangleArea(const double ax, const double ay, const double bx, const double by)
+{
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    const double a = dx * dx + dy * dy;
+    if (a == 0.) {
+        return 0.;
+    }
+    const double sectorAB = 0.5 * atan2(ax * by - ay * bx, ax * bx + ay * by);
+
+    // The segment is inside the circle for t in [tIn, tOut] where the point
+    // on the segment is a + t.(b - a)
+    const double b = ax * dx + ay * dy;
+    const double c = ax * ax + ay * ay - 1.;
+    const double disc = b * b - a * c;
+    if (disc <= 0.) {
+        return sectorAB;
+    }
+    const double root = sqrt(disc);
+    const double tIn = std::max(0., (-b - root) / a);
+    const double tOut = std::min(1., (-b + root) / a);
+    if (tIn >= tOut) {
+        return sectorAB;
+    }
+
+    const double px = ax + tIn * dx;
+    const double py = ay + tIn * dy;
+    const double qx = ax + tOut * dx;
+    const double qy = ay + tOut * dy;
+    const double sectorAP = 0.5 * atan2(ax * py - ay * px, ax * px + ay * py);
+    const double trianglePQ = 0.5 * (px * qy - py * qx);
+    const double sectorQB = 0.5 * atan2(qx * by - qy * bx, qx * bx + qy * by);
+    return sectorAP + trianglePQ + sectorQB;
+}
+
+}
+
+DiskEvaluator::DiskEvaluator()
+    : itsXCenter(0.), itsYCenter(0.), itsSemiMajor(0.5 * MIN_AXIS),
+      itsSemiMinor(0.5 * MIN_AXIS), itsCosPa(1.), itsSinPa(0.), itsScale(0.)
+{
+}
+
+DiskEvaluator::DiskEvaluator(const double xCenter, const double yCenter,
+                             const double majorAxis, const double minorAxis,
+                             const double pa, const double flux)
+    : itsXCenter(xCenter), itsYCenter(yCenter),
+      itsSemiMajor(0.5 * std::max(MIN_AXIS, majorAxis)),
+      itsSemiMinor(0.5 * std::max(MIN_AXIS, minorAxis)),
+      itsCosPa(cos(pa)), itsSinPa(sin(pa)), itsScale(flux / M_PI)
+{
+}
+
+void DiskEvaluator::extent(double& halfWidthX, double& halfWidthY) const
+{
+    // The minor axis is along (cos(pa), sin(pa)) and the major axis along
+    // (-sin(pa), cos(pa))
+    halfWidthX = sqrt(itsSemiMinor * itsSemiMinor * itsCosPa * itsCosPa
+                      + itsSemiMajor * itsSemiMajor * itsSinPa * itsSinPa);
+    halfWidthY = sqrt(itsSemiMinor * itsSemiMinor * itsSinPa * itsSinPa
+                      + itsSemiMajor * itsSemiMajor * itsCosPa * itsCosPa);
+}
+
+double DiskEvaluator::pixel(const int x, const int y) const
+{
+    // The corners of the pixel, anticlockwise, in the frame where the disk
+    // is the unit circle. The mapping has a positive determinant, so the
+    // corners stay anticlockwise.
+    const double xs[4] = {x - 0.5, x + 0.5, x + 0.5, x - 0.5};
+    const double ys[4] = {y - 0.5, y - 0.5, y + 0.5, y + 0.5};
+    double u[4];
+    double v[4];
+    bool allInside = true;
+    double uMin = 0., uMax = 0., vMin = 0., vMax = 0.;
+    for (int i = 0; i < 4; ++i) {
+        const double dx = xs[i] - itsXCenter;
+        const double dy = ys[i] - itsYCenter;
+        u[i] = (dx * itsCosPa + dy * itsSinPa) / itsSemiMinor;
+        v[i] = (dy * itsCosPa - dx * itsSinPa) / itsSemiMajor;
+        allInside = allInside && (u[i] * u[i] + v[i] * v[i] <= 1.);
+        uMin = (i == 0) ? u[i] : std::min(uMin, u[i]);
+        uMax = (i == 0) ? u[i] : std::max(uMax, u[i]);
+        vMin = (i == 0) ? v[i] : std::min(vMin, v[i]);
+        vMax = (i == 0) ? v[i] : std::max(vMax, v[i]);
+    }
+
+    // The area of the pixel in the unit circle frame
+    const double pixelArea = 1. / (itsSemiMajor * itsSemiMinor);
+    if (allInside) {
+        return itsScale * pixelArea;
+    }
+    if (uMin >= 1. || uMax <= -1. || vMin >= 1. || vMax <= -1.) {
+        return 0.;
+    }
+
+    double area = 0.;
+    for (int i = 0; i < 4; ++i) {
+        const int j = (i + 1) % 4;
+        area += triangleArea(u[i], v[i], u[j], v[j]);
+    }
+    return itsScale * std::min(pixelArea, std::max(0., area));
+}
+
+void DiskEvaluator::row(const int ypix, const int startX, const unsigned int n,
+                        double* out) const
+{
+    for (unsigned int pix = 0; pix < n; ++pix) {
+        out[pix] = pixel(startX + static_cast<int>(pix), ypix);
+    }
+}
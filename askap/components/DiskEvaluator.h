@@ -0,0 +1,106 @@
+/// @file DiskEvaluator.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_DISKEVALUATOR_H
+#define ASKAP_COMPONENTS_DISKEVALUATOR_H
+
+namespace askap {
+namespace components {
+
+/// @brief Evaluates the flux of a uniform elliptical disk in each pixel.
+///
+/// The disk is parameterised as for casacore::Gaussian2D, with the major
+/// axis along the y axis when the position angle is zero, but the axes are
+/// the full widths of the disk rather than FWHMs. The flux in a pixel is the
+/// exact area of overlap between the pixel and the disk, times the surface
+/// brightness. The overlap is found by mapping the pixel onto the frame in
+/// which the disk is a unit circle, where the pixel is a parallelogram, and
+/// summing the area of the circle within the triangle formed by the centre
+/// and each edge. Pixel (x, y) covers [x - 0.5, x + 0.5) x [y - 0.5, y + 0.5).
+///
+/// Axes narrower than 1e-3 pixels are widened to 1e-3 pixels, so a disk of
+/// zero width is rendered as a line (or a point) with the same total flux.
+///
+/// Thread Safety:
+/// The evaluate functions do not modify the instance, so one instance may be
+/// shared between threads.
+class DiskEvaluator {
+    public:
+
+        /// Constructor
+        /// Creates a disk of zero flux at the origin
+        DiskEvaluator();
+
+        /// Constructor
+        ///
+        /// @param[in] xCenter      the x-coordinate of the centre, in pixels
+        /// @param[in] yCenter      the y-coordinate of the centre, in pixels
+        /// @param[in] majorAxis    the width of the major axis, in pixels
+        /// @param[in] minorAxis    the width of the minor axis, in pixels
+        /// @param[in] pa           the position angle of the major axis, in radians
+        /// @param[in] flux         the integrated flux
+        DiskEvaluator(const double xCenter, const double yCenter,
+                      const double majorAxis, const double minorAxis,
+                      const double pa, const double flux);
+
+        /// Find the half widths of the bounding box of the disk.
+        ///
+        /// @param[out] halfWidthX  the half width along the x axis, in pixels
+        /// @param[out] halfWidthY  the half width along the y axis, in pixels
+        void extent(double& halfWidthX, double& halfWidthY) const;
+
+        /// @return the flux in pixel (x, y)
+        double pixel(const int x, const int y) const;
+
+        /// Evaluate the flux in a contiguous row of pixels.
+        ///
+        /// @param[in] ypix     the y-coordinate of the row
+        /// @param[in] startX   the x-coordinate of the first pixel of the row
+        /// @param[in] n        the number of pixels in the row
+        /// @param[out] out     the flux in each of the n pixels
+        void row(const int ypix, const int startX, const unsigned int n, double* out) const;
+
+    private:
+        // Centre of the disk
+        double itsXCenter;
+        double itsYCenter;
+
+        // The (semi) major and minor axes, in pixels
+        double itsSemiMajor;
+        double itsSemiMinor;
+
+        // The direction of the minor axis
+        double itsCosPa;
+        double itsSinPa;
+
+        // The flux per unit area of the unit circle frame, i.e. flux / pi
+        double itsScale;
+};
+
+}
+}
+
+#endif
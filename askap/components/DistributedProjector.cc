@@ -0,0 +1,221 @@
+/// @file DistributedProjector.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "DistributedProjector.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/IPosition.h"
+#include "casacore/casa/Arrays/Slicer.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/coordinates/Coordinates/CoordinateUtil.h"
+#include "casacore/coordinates/Coordinates/DirectionCoordinate.h"
+#include "casacore/images/Images/SubImage.h"
+#include "casacore/lattices/Lattices/TiledShape.h"
+
+// Local package includes
+#include "AskapComponentImager.h"
+
+using namespace askap;
+using namespace askap::components;
+using namespace casacore;
+
+namespace {
+
+/// @return the spectral pixel axis of a coordinate system
+Int spectralAxis(const CoordinateSystem& coords)
+{
+    const Int freqAxis = CoordinateUtil::findSpectralAxis(coords);
+    ASKAPCHECK(freqAxis >= 0, "Image must have a frequency axis");
+    return freqAxis;
+}
+
+}
+
+DistributedProjector::DistributedProjector(ProjectionCommunicator& comm)
+    : itsComm(comm)
+{
+}
+
+void DistributedProjector::channelRange(const casacore::uInt nChannels,
+                                        const casacore::uInt tileChannels,
+                                        const int nRanks, const int rank,
+                                        casacore::uInt& start, casacore::uInt& n)
+{
+    ASKAPCHECK(tileChannels > 0, "Tiles must have at least one channel");
+    ASKAPCHECK(nRanks > 0 && rank >= 0 && rank < nRanks, "Invalid rank");
+
+    // The tiles are shared as evenly as possible, with the first ranks
+    // taking any remainder
+    const uInt nTiles = (nChannels + tileChannels - 1) / tileChannels;
+    const uInt perRank = nTiles / nRanks;
+    const uInt remainder = nTiles % nRanks;
+    const uInt myRank = static_cast<uInt>(rank);
+    const uInt firstTile = myRank * perRank + std::min(myRank, remainder);
+    const uInt myTiles = perRank + ((myRank < remainder) ? 1 : 0);
+    start = std::min(nChannels, firstTile * tileChannels);
+    n = std::min(nChannels, (firstTile + myTiles) * tileChannels) - start;
+}
+
+template <class T>
+void DistributedProjector::project(casacore::ImageInterface<T>& image,
+                                   const casacore::ComponentList& list,
+                                   const unsigned int term,
+                                   const ProjectionOptions& options)
+{
+    const IPosition shape = image.shape();
+    const Int freqAxis = spectralAxis(image.coordinates());
+    uInt start;
+    uInt n;
+    channelRange(shape(freqAxis), std::max(1, static_cast<int>(image.niceCursorShape()(freqAxis))),
+                 itsComm.nRanks(), itsComm.rank(), start, n);
+
+    // Every rank takes part in sharing the positions, even with no channels
+    PixelPositionCache& cache = options.positionCache ? *options.positionCache
+                                : itsPositionCache;
+    sharePositions(cache, list, image.coordinates(), options);
+    if (n == 0) {
+        return;
+    }
+
+    IPosition blc(shape.nelements(), 0);
+    blc(freqAxis) = start;
+    IPosition length(shape);
+    length(freqAxis) = n;
+    SubImage<T> slab(image, Slicer(blc, length), True);
+    ProjectionOptions slabOptions(options);
+    slabOptions.positionCache = &cache;
+    AskapComponentImager::project(slab, list, term, slabOptions);
+}
+
+template <class T>
+casacore::TempImage<T> DistributedProjector::projectSlab(const casacore::IPosition& shape,
+        const casacore::CoordinateSystem& coords,
+        const casacore::ComponentList& list,
+        const unsigned int term,
+        const ProjectionOptions& options,
+        casacore::IPosition& start)
+{
+    // There is no image to prefer a cursor shape, so the channels are
+    // shared individually
+    const Int freqAxis = spectralAxis(coords);
+    uInt startChannel;
+    uInt n;
+    channelRange(shape(freqAxis), 1, itsComm.nRanks(), itsComm.rank(), startChannel, n);
+
+    PixelPositionCache& cache = options.positionCache ? *options.positionCache
+                                : itsPositionCache;
+    sharePositions(cache, list, coords, options);
+    ASKAPCHECK(n > 0, "Rank " << itsComm.rank() << " has no channels");
+
+    // The slab's coordinates are those of the cube, shifted to its first channel
+    start = IPosition(shape.nelements(), 0);
+    start(freqAxis) = startChannel;
+    IPosition slabShape(shape);
+    slabShape(freqAxis) = n;
+    Vector<Float> originShift(shape.nelements(), 0.0);
+    originShift(freqAxis) = startChannel;
+    const Vector<Float> increment(shape.nelements(), 1.0);
+    Vector<Int> newShape(shape.nelements());
+    for (uInt axis = 0; axis < shape.nelements(); ++axis) {
+        newShape(axis) = slabShape(axis);
+    }
+    TempImage<T> slab(TiledShape(slabShape), coords.subImage(originShift, increment, newShape));
+    slab.set(0.0);
+
+    ProjectionOptions slabOptions(options);
+    slabOptions.positionCache = &cache;
+    AskapComponentImager::project(slab, list, term, slabOptions);
+    return slab;
+}
+
+void DistributedProjector::sharePositions(PixelPositionCache& cache,
+        const casacore::ComponentList& list,
+        const casacore::CoordinateSystem& coords,
+        const ProjectionOptions& options)
+{
+    // A single rank converts the positions when it projects. With an index
+    // only the candidates are converted, and cached, by each rank.
+    if (itsComm.nRanks() == 1 || list.nelements() == 0 || options.componentIndex) {
+        return;
+    }
+
+    // The direction coordinate as AskapComponentImager::project() uses it,
+    // so the cache entry matches exactly
+    DirectionCoordinate dirCoord = coords.directionCoordinate(
+                                       coords.findCoordinate(Coordinate::DIRECTION));
+    dirCoord.setWorldAxisUnits(Vector<String>(2, "rad"));
+
+    // The caches of the ranks need not hold the same entries (a rank with no
+    // channels doesn't use its cache, and the caller may provide different
+    // caches), so only rank 0 decides whether the positions are sent. It
+    // sends no positions if it holds them already, in which case another
+    // rank which doesn't converts them itself. If the conversion fails the
+    // other ranks are still waiting in the broadcast, so rank 0 sends a
+    // single NaN in place of the positions and every rank then throws.
+    std::vector<double> positions;
+    std::string error;
+    if (itsComm.rank() == 0 && !cache.contains(list, dirCoord)) {
+        try {
+            positions = cache.positions(list, dirCoord);
+        } catch (const AskapError& e) {
+            error = e.what();
+            positions.assign(1, std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+    itsComm.broadcast(positions, 0);
+    if (positions.size() == 1 && std::isnan(positions[0])) {
+        ASKAPTHROW(AskapError, "Rank 0 failed to convert the component positions"
+                   << (error.empty() ? "" : ": ") << error);
+    }
+    if (itsComm.rank() != 0 && !positions.empty()) {
+        cache.insert(list, dirCoord, positions);
+    }
+}
+
+// Explicit instantiation
+template void DistributedProjector::project(casacore::ImageInterface<float>&,
+        const casacore::ComponentList&, const unsigned int, const ProjectionOptions&);
+template void DistributedProjector::project(casacore::ImageInterface<double>&,
+        const casacore::ComponentList&, const unsigned int, const ProjectionOptions&);
+template casacore::TempImage<float> DistributedProjector::projectSlab(const casacore::IPosition&,
+        const casacore::CoordinateSystem&, const casacore::ComponentList&, const unsigned int,
+        const ProjectionOptions&, casacore::IPosition&);
+template casacore::TempImage<double> DistributedProjector::projectSlab(const casacore::IPosition&,
+        const casacore::CoordinateSystem&, const casacore::ComponentList&, const unsigned int,
+        const ProjectionOptions&, casacore::IPosition&);
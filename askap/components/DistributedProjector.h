@@ -0,0 +1,171 @@
+/// @file DistributedProjector.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_DISTRIBUTEDPROJECTOR_H
+#define ASKAP_COMPONENTS_DISTRIBUTEDPROJECTOR_H
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/IPosition.h"
+#include "casacore/coordinates/Coordinates/CoordinateSystem.h"
+#include "casacore/images/Images/ImageInterface.h"
+#include "casacore/images/Images/TempImage.h"
+#include "casarest/components/ComponentModels/ComponentList.h"
+
+// Local package includes
+#include "PixelPositionCache.h"
+#include "ProjectionCommunicator.h"
+#include "ProjectionOptions.h"
+
+namespace askap {
+namespace components {
+
+/// @brief Projects a component list onto an image cube shared by several
+/// processes, each of which renders a range of channels.
+///
+/// The spectral axis is divided into one contiguous range of channels per
+/// rank. When writing into an image of the whole cube the ranges are whole
+/// multiples of the image's preferred cursor shape along that axis (so a
+/// paged image is written a whole number of tiles at a time).
+/// The pixel positions of the components are converted once, by rank 0, and
+/// broadcast to the other ranks, which then only find the flux of each
+/// component for their own channels. With a component index each rank converts
+/// the positions of its candidates itself, as there are few. Each rank can
+/// either write its channels directly into an image of the whole cube (e.g. one
+/// on a parallel filesystem), or render them into a slab image which the caller
+/// writes collectively.
+///
+/// The result is identical to AskapComponentImager::project() of the whole
+/// cube by a single process.
+///
+/// Thread Safety:
+/// This class is not thread safe. The calls which communicate are
+/// collective, so every rank must make the same sequence of calls with the
+/// same component lists and direction coordinates.
+class DistributedProjector {
+    public:
+        /// Constructor
+        ///
+        /// @param[in] comm     the communicator of the ranks sharing the
+        ///                     cube, which must outlive the projector.
+        explicit DistributedProjector(ProjectionCommunicator& comm);
+
+        /// Find the channels of a rank.
+        ///
+        /// @param[in] nChannels    the number of channels of the cube.
+        /// @param[in] tileChannels the granularity of the ranges, which are
+        ///                         multiples of this other than the last.
+        /// @param[in] nRanks       the number of ranks.
+        /// @param[in] rank         the rank.
+        /// @param[out] start       the first channel of the rank.
+        /// @param[out] n           the number of channels of the rank, which
+        ///                         is zero if there are more ranks than tiles.
+        static void channelRange(const casacore::uInt nChannels,
+                                 const casacore::uInt tileChannels,
+                                 const int nRanks, const int rank,
+                                 casacore::uInt& start, casacore::uInt& n);
+
+        /// Project a component list onto the channels of this rank. This is
+        /// a collective operation.
+        ///
+        /// @param[inout] image     an image of the whole cube. Only the
+        ///                         channels of this rank are accessed.
+        /// @param[in] list         the component list to project.
+        /// @param[in] term         the taylor term to image.
+        /// @param[in] options      the options for the projection. A position
+        ///                         cache the options refer to is used in
+        ///                         place of the projector's own.
+        /// @throw AskapError   as for AskapComponentImager::project(). If
+        ///                     rank 0 cannot convert the positions of the
+        ///                     list, every rank throws.
+        template <class T>
+        void project(casacore::ImageInterface<T>& image,
+                     const casacore::ComponentList& list,
+                     const unsigned int term = 0,
+                     const ProjectionOptions& options = ProjectionOptions());
+
+        /// Project a component list onto a slab image holding only the
+        /// channels of this rank, e.g. for a collective write by the caller.
+        /// The channels are shared as evenly as possible, rather than in
+        /// whole tiles. This is a collective operation.
+        ///
+        /// @param[in] shape        the shape of the whole cube.
+        /// @param[in] coords       the coordinate system of the whole cube.
+        /// @param[in] list         the component list to project.
+        /// @param[in] term         the taylor term to image.
+        /// @param[in] options      the options for the projection, as above.
+        /// @param[out] start       the position of the first pixel of the
+        ///                         slab within the cube.
+        /// @return the slab, with the shape of the cube other than along the
+        ///         spectral axis.
+        /// @throw AskapError   as for project(), or if this rank has no
+        ///                     channels (there are more ranks than channels).
+        template <class T>
+        casacore::TempImage<T> projectSlab(const casacore::IPosition& shape,
+                                           const casacore::CoordinateSystem& coords,
+                                           const casacore::ComponentList& list,
+                                           const unsigned int term,
+                                           const ProjectionOptions& options,
+                                           casacore::IPosition& start);
+
+    private:
+        // Make sure the position cache holds the pixel positions of the
+        // list, converting them on rank 0 and broadcasting them if rank 0
+        // does not already hold them
+        void sharePositions(PixelPositionCache& cache,
+                            const casacore::ComponentList& list,
+                            const casacore::CoordinateSystem& coords,
+                            const ProjectionOptions& options);
+
+        ProjectionCommunicator& itsComm;
+
+        // The positions converted by rank 0, used unless the options
+        // provide a cache
+        PixelPositionCache itsPositionCache;
+};
+
+// Explicit instantiations exist for float and double types only
+extern template void
+DistributedProjector::project(casacore::ImageInterface<float>&,
+                              const casacore::ComponentList&, const unsigned int,
+                              const ProjectionOptions&);
+extern template void
+DistributedProjector::project(casacore::ImageInterface<double>&,
+                              const casacore::ComponentList&, const unsigned int,
+                              const ProjectionOptions&);
+extern template casacore::TempImage<float>
+DistributedProjector::projectSlab(const casacore::IPosition&, const casacore::CoordinateSystem&,
+                                  const casacore::ComponentList&, const unsigned int,
+                                  const ProjectionOptions&, casacore::IPosition&);
+extern template casacore::TempImage<double>
+DistributedProjector::projectSlab(const casacore::IPosition&, const casacore::CoordinateSystem&,
+                                  const casacore::ComponentList&, const unsigned int,
+                                  const ProjectionOptions&, casacore::IPosition&);
+
+}
+}
+
+#endif
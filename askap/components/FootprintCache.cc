@@ -0,0 +1,99 @@
+/// @file FootprintCache.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+// Include own header file first
+#include "FootprintCache.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <cmath>
+#include <list>
+#include <map>
+#include <tuple>
+#include <utility>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+
+using namespace askap;
+using namespace askap::components;
+
+bool FootprintCache::Key::operator<(const Key& other) const
+{
+    return std::tie(major, minor, pa, flux, xOffset, yOffset, startLat, startLon,
+                    nLat, nLon, kernel, precision)
+           < std::tie(other.major, other.minor, other.pa, other.flux, other.xOffset,
+                      other.yOffset, other.startLat, other.startLon, other.nLat, other.nLon,
+                      other.kernel, other.precision);
+}
+
+FootprintCache::FootprintCache(const size_t maxEntries, const unsigned int subpixelSteps)
+    : itsMaxEntries(maxEntries), itsSubpixelSteps(subpixelSteps), itsHits(0), itsMisses(0)
+{
+    ASKAPCHECK(maxEntries > 0, "Cache must hold at least one entry");
+}
+
+double FootprintCache::quantise(const double offset) const
+{
+    if (itsSubpixelSteps == 0) {
+        return offset;
+    }
+    return round(offset * itsSubpixelSteps) / itsSubpixelSteps;
+}
+
+const ComponentFootprint* FootprintCache::find(const Key& key)
+{
+    const std::map<Key, EntryList::iterator>::iterator it = itsIndex.find(key);
+    if (it == itsIndex.end()) {
+        ++itsMisses;
+        return 0;
+    }
+    itsEntries.splice(itsEntries.begin(), itsEntries, it->second);
+    ++itsHits;
+    return &it->second->second;
+}
+
+void FootprintCache::insert(const Key& key, const ComponentFootprint& footprint)
+{
+    const std::map<Key, EntryList::iterator>::iterator it = itsIndex.find(key);
+    if (it != itsIndex.end()) {
+        itsEntries.erase(it->second);
+        itsIndex.erase(it);
+    }
+    itsEntries.push_front(std::make_pair(key, footprint));
+    itsIndex[key] = itsEntries.begin();
+    if (itsEntries.size() > itsMaxEntries) {
+        itsIndex.erase(itsEntries.back().first);
+        itsEntries.pop_back();
+    }
+}
+
+void FootprintCache::clear(void)
+{
+    itsEntries.clear();
+    itsIndex.clear();
+}
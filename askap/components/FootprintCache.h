@@ -0,0 +1,150 @@
+/// @file FootprintCache.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+#ifndef ASKAP_COMPONENTS_FOOTPRINTCACHE_H
+#define ASKAP_COMPONENTS_FOOTPRINTCACHE_H
+
+// System includes
+#include <cstddef>
+#include <list>
+#include <map>
+#include <utility>
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+
+// Local package includes
+#include "ComponentFootprint.h"
+
+namespace askap {
+namespace components {
+
+/// @brief Caches the unit flux footprints of gaussians, so components which
+/// share a shape are rendered by copying a footprint rather than integrating
+/// every pixel again.
+///
+/// A footprint is identified by the shape and flux of the gaussian in pixels,
+/// the offset of its centre from the pixel below it, the extent of the
+/// footprint relative to that pixel and the integration kernel. The flux is
+/// one, other than when restoring, when it is the area of the restoring beam.
+/// Catalogues often hold many gaussians of exactly the same size (e.g. fitted
+/// sizes quantised to the beam, or restored point sources) but their centres
+/// fall anywhere within a pixel, so the offsets are rounded to a grid of
+/// subpixel steps. A component whose footprint comes from the cache is
+/// therefore moved by up to half a step along each axis. The footprints are
+/// evaluated at the rounded offset relative to a fixed origin, so a cached
+/// footprint does not depend on which component it was made for.
+///
+/// Entries beyond the capacity of the cache are discarded in least recently
+/// used order.
+///
+/// Thread Safety:
+/// This class is not thread safe. A cache must not be used by concurrent
+/// calls to AskapComponentImager::project().
+class FootprintCache {
+    public:
+        /// Identifies the footprint of a gaussian
+        struct Key {
+            /// The shape, in pixels and radians
+            double major;
+            double minor;
+            double pa;
+
+            /// The flux of the footprint, which depends on the restoring beam
+            double flux;
+
+            /// The (rounded) offset of the centre from the pixel below it,
+            /// along each axis, in the range [0, 1]
+            double xOffset;
+            double yOffset;
+
+            /// The extent of the footprint, relative to the pixel below the centre
+            int startLat;
+            int startLon;
+            casacore::uInt nLat;
+            casacore::uInt nLon;
+
+            /// The integration kernel, and the size of the pixel type in bytes,
+            /// since both change the values of the footprint
+            int kernel;
+            int precision;
+
+            bool operator<(const Key& other) const;
+        };
+
+        /// Constructor
+        ///
+        /// @param[in] maxEntries       the number of footprints to retain. Must
+        ///                             be at least one.
+        /// @param[in] subpixelSteps    the number of steps per pixel to which
+        ///                             the centre is rounded, or zero to use
+        ///                             the exact centre.
+        explicit FootprintCache(const size_t maxEntries = 4096,
+                                const unsigned int subpixelSteps = 16);
+
+        /// @return the offset of a centre from the pixel below it, rounded
+        ///         to the nearest subpixel step.
+        double quantise(const double offset) const;
+
+        /// Find a footprint, which becomes the most recently used.
+        ///
+        /// @return the footprint, or null if it is not cached. The pointer
+        ///         is valid until the next call to insert() or clear().
+        const ComponentFootprint* find(const Key& key);
+
+        /// Add a footprint as the most recently used, discarding the least
+        /// recently used if the cache is full
+        void insert(const Key& key, const ComponentFootprint& footprint);
+
+        /// @return the number of calls to find() which returned a footprint
+        size_t hits(void) const { return itsHits; }
+
+        /// @return the number of calls to find() which did not
+        size_t misses(void) const { return itsMisses; }
+
+        /// @return the number of footprints cached
+        size_t size(void) const { return itsEntries.size(); }
+
+        /// Discard all entries
+        void clear(void);
+
+    private:
+        typedef std::list<std::pair<Key, ComponentFootprint> > EntryList;
+
+        size_t itsMaxEntries;
+        unsigned int itsSubpixelSteps;
+
+        // Most recently used first, with an index by key
+        EntryList itsEntries;
+        std::map<Key, EntryList::iterator> itsIndex;
+
+        size_t itsHits;
+        size_t itsMisses;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,339 @@
+/// @file GaussianRowEvaluator.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "GaussianRowEvaluator.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+
+// Local package includes
+#include "Simd.h"
+
+using namespace askap;
+using namespace askap::components;
+
+namespace {
+
+/// 6 point Gauss-Legendre abscissae and weights on [-1, 1]
+const int N_NODES = 6;
+const double NODES[N_NODES] = {
+    -0.9324695142031521, -0.6612093864662645, -0.2386191860831969,
+    0.2386191860831969, 0.6612093864662645, 0.9324695142031521
+};
+const double WEIGHTS[N_NODES] = {
+    0.1713244923791704, 0.3607615730481386, 0.4679139345726910,
+    0.4679139345726910, 0.3607615730481386, 0.1713244923791704
+};
+
+/// Exponential function for x <= 0, accurate to better than 2 ulp, written
+/// without branches or calls so it vectorises. The argument is reduced to
+/// r = x - n.ln(2) with |r| <= ln(2)/2, exp(r) is found with the Cephes Pade
+/// approximation and the result scaled by 2^n via the exponent bits. Results
+/// which would be subnormal are flushed to zero.
+inline double vexp(const double x)
+{
+    const double log2e = 1.4426950408889634074;
+    const double ln2Hi = 6.93145751953125e-1;
+    const double ln2Lo = 1.42860682030941723212e-6;
+    // Adding 1.5 * 2^52 rounds to an integer, held in the low mantissa bits
+    const double shift = 6755399441055744.0;
+    const double minArg = -708.0;
+
+    const double xc = std::max(x, minArg);
+    const double kd = xc * log2e + shift;
+    const double n = kd - shift;
+    const double r = (xc - n * ln2Hi) - n * ln2Lo;
+    const double rr = r * r;
+    const double p = r * ((1.26177193074810590878e-4 * rr + 3.02994407707441961300e-2) * rr
+                          + 9.99999999999999999910e-1);
+    const double q = ((3.00198505138664455042e-6 * rr + 2.52448340349684104192e-3) * rr
+                      + 2.27265548208155028766e-1) * rr + 2.00000000000000000009e0;
+    const double er = 1.0 + 2.0 * p / (q - p);
+
+    // 2^n from the exponent bits. The integer n is in the low bits of kd, and
+    // shifting it into the exponent field discards the bits of the shift.
+    uint64_t bits;
+    std::memcpy(&bits, &kd, sizeof(bits));
+    bits = (bits + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+
+    return (x < minArg) ? 0.0 : er * scale;
+}
+
+/// Exponential function for x <= 0 in single precision, accurate to better
+/// than 2 ulp, as for vexp() but with the Cephes polynomial for expf.
+/// Results which would be subnormal are flushed to zero.
+inline float vexpf(const float x)
+{
+    const float log2e = 1.44269504088896341f;
+    const float ln2Hi = 0.693359375f;
+    const float ln2Lo = -2.12194440e-4f;
+    // Adding 1.5 * 2^23 rounds to an integer, held in the low mantissa bits
+    const float shift = 12582912.0f;
+    const float minArg = -87.0f;
+
+    const float xc = std::max(x, minArg);
+    const float kf = xc * log2e + shift;
+    const float n = kf - shift;
+    const float r = (xc - n * ln2Hi) - n * ln2Lo;
+    const float p = ((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r
+                      + 4.1665795894e-2f) * r + 1.6666665459e-1f) * r + 5.0000001201e-1f;
+    const float er = (p * r * r + r) + 1.0f;
+
+    // 2^n from the exponent bits, as for vexp()
+    uint32_t bits;
+    std::memcpy(&bits, &kf, sizeof(bits));
+    bits = (bits + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+
+    return (x < minArg) ? 0.0f : er * scale;
+}
+
+}
+
+GaussianRowEvaluator::GaussianRowEvaluator()
+    : itsXCenter(0.), itsYCenter(0.), itsA(0.), itsB(0.), itsC(0.), itsHeight(0.),
+      itsFlux(0.), itsSigmaMinor(0.), itsDelta(0.), itsNSteps(0)
+{
+}
+
+GaussianRowEvaluator::GaussianRowEvaluator(const double xCenter, const double yCenter,
+        const double majorAxis, const double minorAxis,
+        const double pa, const double flux)
+{
+    reset(xCenter, yCenter, majorAxis, minorAxis, pa, flux);
+}
+
+void GaussianRowEvaluator::reset(const double xCenter, const double yCenter,
+                                 const double majorAxis, const double minorAxis,
+                                 const double pa, const double flux)
+{
+    itsXCenter = xCenter;
+    itsYCenter = yCenter;
+    itsFlux = flux;
+    const double fwhmToSigma = 1. / (2. * M_SQRT2 * sqrt(M_LN2));
+    const double sigmaMajor = majorAxis * fwhmToSigma;
+    itsSigmaMinor = minorAxis * fwhmToSigma;
+    itsHeight = flux / (2. * M_PI * sigmaMajor * itsSigmaMinor);
+
+    // Rotate the major (y) and minor (x) axes by the position angle
+    const double cpa = cos(pa);
+    const double spa = sin(pa);
+    const double majorTerm = 0.5 / (sigmaMajor * sigmaMajor);
+    const double minorTerm = 0.5 / (itsSigmaMinor * itsSigmaMinor);
+    itsA = cpa * cpa * minorTerm + spa * spa * majorTerm;
+    itsB = cpa * spa * (minorTerm - majorTerm);
+    itsC = spa * spa * minorTerm + cpa * cpa * majorTerm;
+
+    // Simpson's rule sampling, as for AskapComponentImager::evaluateGaussian2D()
+    const double minSigma = std::min(sigmaMajor, itsSigmaMinor);
+    itsDelta = std::min(1. / 32.,
+                        pow(10., floor(log10(minSigma / 5.) / log10(2.)) * log10(2.)));
+    itsNSteps = static_cast<unsigned int>(1. / itsDelta);
+    itsSimpsonWeights.resize(itsNSteps + 1);
+    for (unsigned int i = 0; i <= itsNSteps; ++i) {
+        if (i == 0 || i == itsNSteps) {
+            itsSimpsonWeights[i] = 1.;
+        } else {
+            itsSimpsonWeights[i] = (i % 2 == 1) ? 4. : 2.;
+        }
+    }
+}
+
+void GaussianRowEvaluator::simpson(const int ypix, const int startX,
+                                   const unsigned int n, double* out)
+{
+    const unsigned int nSamples = itsNSteps + 1;
+    const unsigned int nTotal = n * nSamples;
+    itsOffsets.resize(nTotal);
+    itsValues.resize(nTotal);
+
+    // The x offset from the centre of every sample along the row
+    for (unsigned int pix = 0; pix < n; ++pix) {
+        const double first = (startX + static_cast<int>(pix)) - 0.5 - itsXCenter;
+        double* offsets = &itsOffsets[pix * nSamples];
+        for (unsigned int i = 0; i < nSamples; ++i) {
+            offsets[i] = first + i * itsDelta;
+        }
+    }
+
+    std::fill(out, out + n, 0.);
+    const double* offsets = &itsOffsets[0];
+    double* values = &itsValues[0];
+    const double a = itsA;
+    const double b2 = 2. * itsB;
+    for (unsigned int j = 0; j < nSamples; ++j) {
+        const double dy = (ypix - 0.5 + j * itsDelta) - itsYCenter;
+        const double bTerm = b2 * dy;
+        const double cTerm = itsC * dy * dy;
+        ASKAP_SIMD
+        for (unsigned int i = 0; i < nTotal; ++i) {
+            values[i] = vexp(-((a * offsets[i] + bTerm) * offsets[i] + cTerm));
+        }
+
+        const double yWeight = itsSimpsonWeights[j];
+        for (unsigned int pix = 0; pix < n; ++pix) {
+            const double* pixValues = values + pix * nSamples;
+            double sum = 0.;
+            for (unsigned int i = 0; i < nSamples; ++i) {
+                sum += pixValues[i] * itsSimpsonWeights[i];
+            }
+            out[pix] += sum * yWeight;
+        }
+    }
+
+    const double scale = itsHeight * itsDelta * itsDelta / 9.;
+    for (unsigned int pix = 0; pix < n; ++pix) {
+        out[pix] *= scale;
+    }
+}
+
+void GaussianRowEvaluator::simpsonSingle(const int ypix, const int startX,
+        const unsigned int n, double* out)
+{
+    const unsigned int nSamples = itsNSteps + 1;
+    const unsigned int nTotal = n * nSamples;
+    itsOffsetsSingle.resize(nTotal);
+    itsValuesSingle.resize(nTotal);
+
+    // The offsets are relative to the centre, so are small enough to be
+    // held in single precision
+    for (unsigned int pix = 0; pix < n; ++pix) {
+        const double first = (startX + static_cast<int>(pix)) - 0.5 - itsXCenter;
+        float* offsets = &itsOffsetsSingle[pix * nSamples];
+        for (unsigned int i = 0; i < nSamples; ++i) {
+            offsets[i] = static_cast<float>(first + i * itsDelta);
+        }
+    }
+
+    std::fill(out, out + n, 0.);
+    const float* offsets = &itsOffsetsSingle[0];
+    float* values = &itsValuesSingle[0];
+    const float a = static_cast<float>(itsA);
+    const float b2 = static_cast<float>(2. * itsB);
+    const float c = static_cast<float>(itsC);
+    for (unsigned int j = 0; j < nSamples; ++j) {
+        const float dy = static_cast<float>((ypix - 0.5 + j * itsDelta) - itsYCenter);
+        const float bTerm = b2 * dy;
+        const float cTerm = c * dy * dy;
+        ASKAP_SIMD
+        for (unsigned int i = 0; i < nTotal; ++i) {
+            values[i] = vexpf(-((a * offsets[i] + bTerm) * offsets[i] + cTerm));
+        }
+
+        // Each row of samples is summed in single precision, and the rows
+        // in double precision
+        const double yWeight = itsSimpsonWeights[j];
+        for (unsigned int pix = 0; pix < n; ++pix) {
+            const float* pixValues = values + pix * nSamples;
+            float sum = 0.f;
+            ASKAP_SIMD_SUM(sum)
+            for (unsigned int i = 0; i < nSamples; ++i) {
+                sum += pixValues[i] * static_cast<float>(itsSimpsonWeights[i]);
+            }
+            out[pix] += sum * yWeight;
+        }
+    }
+
+    const double scale = itsHeight * itsDelta * itsDelta / 9.;
+    for (unsigned int pix = 0; pix < n; ++pix) {
+        out[pix] *= scale;
+    }
+}
+
+void GaussianRowEvaluator::analytic(const int ypix, const int startX,
+                                    const unsigned int n, double* out)
+{
+    // The error function is evaluated at the n + 1 pixel edges along the row
+    itsOffsets.resize(n + 1);
+    itsValues.resize(n + 1);
+    const double firstEdge = startX - 0.5 - itsXCenter;
+    double* edges = &itsOffsets[0];
+    for (unsigned int i = 0; i <= n; ++i) {
+        edges[i] = firstEdge + i;
+    }
+    double* edgeErf = &itsValues[0];
+
+    const double ymin = ypix - 0.5 - itsYCenter;
+    const double ymax = ymin + 1.;
+    const double sqrtA = sqrt(itsA);
+    const double sqrtC = sqrt(itsC);
+
+    if (fabs(itsB) <= 1.e-9 * sqrtA * sqrtC) {
+        // Axes are aligned with the pixel grid, so the gaussian is separable
+        // and the integral is the product of two error function differences
+        for (unsigned int i = 0; i <= n; ++i) {
+            edgeErf[i] = erf(sqrtA * edges[i]);
+        }
+        const double yIntegral = erf(sqrtC * ymax) - erf(sqrtC * ymin);
+        const double scale = itsHeight * M_PI / (4. * sqrtA * sqrtC) * yIntegral;
+        for (unsigned int pix = 0; pix < n; ++pix) {
+            out[pix] = scale * (edgeErf[pix + 1] - edgeErf[pix]);
+        }
+        return;
+    }
+
+    // For a given y, completing the square in x gives
+    //     exp(-(c - b^2/a).y^2) * exp(-a.(x + b.y/a)^2)
+    // so the integral over x is an error function difference. The integral
+    // over y is done numerically on panels no wider than two minor axis sigmas.
+    const double yTerm = itsC - itsB * itsB / itsA;
+    const double xShift = itsB / itsA;
+    const int nPanels = std::min(1024, std::max(1, static_cast<int>(ceil(0.5 / itsSigmaMinor))));
+    const double panelWidth = 1. / nPanels;
+
+    std::fill(out, out + n, 0.);
+    for (int panel = 0; panel < nPanels; ++panel) {
+        const double panelCentre = ymin + (panel + 0.5) * panelWidth;
+        for (int node = 0; node < N_NODES; ++node) {
+            const double y = panelCentre + 0.5 * panelWidth * NODES[node];
+            const double weight = WEIGHTS[node] * exp(-yTerm * y * y);
+            const double shift = xShift * y;
+            for (unsigned int i = 0; i <= n; ++i) {
+                edgeErf[i] = erf(sqrtA * (edges[i] + shift));
+            }
+            ASKAP_SIMD
+            for (unsigned int pix = 0; pix < n; ++pix) {
+                out[pix] += weight * (edgeErf[pix + 1] - edgeErf[pix]);
+            }
+        }
+    }
+
+    const double scale = itsHeight * 0.5 * sqrt(M_PI / itsA) * 0.5 * panelWidth;
+    for (unsigned int pix = 0; pix < n; ++pix) {
+        out[pix] *= scale;
+    }
+}
@@ -0,0 +1,164 @@
+/// @file IncrementalProjector.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+// Include own header file first
+#include "IncrementalProjector.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/measures/Measures/MDirection.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "components/ComponentModels/ComponentShape.h"
+#include "components/ComponentModels/Flux.h"
+#include "components/ComponentModels/SpectralModel.h"
+
+// Local package includes
+#include "AskapComponentImager.h"
+
+using namespace askap;
+using namespace askap::components;
+using namespace casacore;
+
+IncrementalProjector::IncrementalProjector(const ProjectionOptions& options)
+    : itsOptions(options), itsNAdded(0), itsNRemoved(0)
+{
+    ASKAPCHECK(!options.spectralModels,
+               "Spectral models are not supported by incremental projection");
+    itsOptions.positionCache = 0;
+    itsOptions.componentIndex = 0;
+}
+
+template <class T>
+void IncrementalProjector::update(casacore::ImageInterface<T>& image,
+                                  const casacore::ComponentList& list,
+                                  const unsigned int term)
+{
+    const ComponentList changes = diff(list);
+    if (changes.nelements() > 0) {
+        AskapComponentImager::project(image, changes, term, itsOptions);
+    }
+}
+
+template <class T>
+void IncrementalProjector::update(const std::vector<casacore::ImageInterface<T>*>& images,
+                                  const casacore::ComponentList& list)
+{
+    const ComponentList changes = diff(list);
+    if (changes.nelements() > 0) {
+        AskapComponentImager::project(images, changes, itsOptions);
+    }
+}
+
+void IncrementalProjector::reset(void)
+{
+    itsProjected.clear();
+    itsNAdded = 0;
+    itsNRemoved = 0;
+}
+
+casacore::ComponentList IncrementalProjector::diff(const casacore::ComponentList& list)
+{
+    // Components are matched by signature, and any left unmatched in the
+    // previous map have been removed or modified
+    ComponentMap previous;
+    previous.swap(itsProjected);
+    ComponentList added;
+    for (uInt i = 0; i < list.nelements(); ++i) {
+        const SkyComponent& c = list.component(i);
+        const Signature sig = signature(c);
+        ComponentMap::iterator it = previous.find(sig);
+        if (it != previous.end()) {
+            itsProjected.insert(*it);
+            previous.erase(it);
+        } else {
+            // A component shares its state with its copies, so keep a deep
+            // copy in case the caller modifies the list in place
+            itsProjected.insert(std::make_pair(sig, c.copy()));
+            added.add(c);
+        }
+    }
+
+    ComponentList changes;
+    for (ComponentMap::const_iterator it = previous.begin(); it != previous.end(); ++it) {
+        SkyComponent negated = it->second.copy();
+        negated.flux().scaleValue(-1.0);
+        changes.add(negated);
+    }
+    itsNRemoved = previous.size();
+    itsNAdded = added.nelements();
+    for (uInt i = 0; i < added.nelements(); ++i) {
+        changes.add(added.component(i));
+    }
+    return changes;
+}
+
+IncrementalProjector::Signature IncrementalProjector::signature(const casacore::SkyComponent& c)
+{
+    Signature sig;
+
+    const MDirection& dir = c.shape().refDirection();
+    const Vector<Double> angles = dir.getAngle().getValue("rad");
+    sig.push_back(static_cast<double>(dir.getRef().getType()));
+    sig.push_back(angles(0));
+    sig.push_back(angles(1));
+
+    sig.push_back(static_cast<double>(c.shape().type()));
+    const Vector<Double> shape = c.shape().parameters();
+    sig.insert(sig.end(), shape.begin(), shape.end());
+
+    // A Flux converts its representation in place, so work on a copy
+    Flux<Double> flux = c.flux().copy();
+    sig.push_back(flux.value(Stokes::I, true).getValue("Jy"));
+    sig.push_back(flux.value(Stokes::Q, true).getValue("Jy"));
+    sig.push_back(flux.value(Stokes::U, true).getValue("Jy"));
+    sig.push_back(flux.value(Stokes::V, true).getValue("Jy"));
+
+    const casacore::SpectralModel& spectrum = c.spectrum();
+    sig.push_back(static_cast<double>(spectrum.type()));
+    sig.push_back(spectrum.refFrequency().getValue().getValue());
+    sig.push_back(static_cast<double>(spectrum.refFrequency().getRef().getType()));
+    const Vector<Double> spectral = spectrum.parameters();
+    sig.insert(sig.end(), spectral.begin(), spectral.end());
+
+    return sig;
+}
+
+// Explicit instantiation
+template void IncrementalProjector::update(casacore::ImageInterface<float>&,
+        const casacore::ComponentList&, const unsigned int);
+template void IncrementalProjector::update(casacore::ImageInterface<double>&,
+        const casacore::ComponentList&, const unsigned int);
+template void IncrementalProjector::update(const std::vector<casacore::ImageInterface<float>*>&,
+        const casacore::ComponentList&);
+template void IncrementalProjector::update(const std::vector<casacore::ImageInterface<double>*>&,
+        const casacore::ComponentList&);
@@ -0,0 +1,149 @@
+/// @file IncrementalProjector.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+#ifndef ASKAP_COMPONENTS_INCREMENTALPROJECTOR_H
+#define ASKAP_COMPONENTS_INCREMENTALPROJECTOR_H
+
+// System includes
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// ASKAPsoft includes
+#include "casacore/images/Images/ImageInterface.h"
+#include "casarest/components/ComponentModels/ComponentList.h"
+#include "casarest/components/ComponentModels/SkyComponent.h"
+
+// Local package includes
+#include "ProjectionOptions.h"
+
+namespace askap {
+namespace components {
+
+/// @brief Keeps an image up to date with a component list which changes a
+/// little between projections, e.g. during self-calibration.
+///
+/// The projector remembers a signature (direction, shape, flux and spectrum)
+/// of every component it has projected. On each update() the new list is
+/// compared with these: components whose signature is no longer present are
+/// subtracted from the image, and components with a new signature are
+/// added, in a single projection. A modified component is both. The cost of
+/// an update depends on the number of components which changed, rather than
+/// the size of the list.
+///
+/// The footprint of a subtracted component is rendered exactly as it was
+/// when added, so the image matches a fresh projection of the new list to
+/// within the rounding of the additions to each pixel.
+///
+/// Thread Safety:
+/// This class is not thread safe. Each update must be given the image (and
+/// taylor term) given to every previous update since construction or the
+/// last reset().
+class IncrementalProjector {
+    public:
+        /// Constructor
+        ///
+        /// @param[in] options  the options for each projection. The position
+        ///                     cache and component index are not used, since
+        ///                     only the changed components are projected.
+        /// @throw AskapError   if the options have spectral models, which
+        ///                     refer to a particular list.
+        explicit IncrementalProjector(const ProjectionOptions& options = ProjectionOptions());
+
+        /// Bring the image up to date with a component list.
+        ///
+        /// @param[inout] image the image, which must be zero (or hold only
+        ///                     other contributions) at the first update.
+        /// @param[in] list     the component list.
+        /// @param[in] term     the taylor term to image.
+        /// @throw AskapError   as for AskapComponentImager::project().
+        template <class T>
+        void update(casacore::ImageInterface<T>& image,
+                    const casacore::ComponentList& list,
+                    const unsigned int term = 0);
+
+        /// Bring one image per taylor term up to date with a component list,
+        /// as for the AskapComponentImager::project() overload for several
+        /// taylor terms.
+        ///
+        /// @param[inout] images    the images, where images[t] holds taylor term t.
+        /// @param[in] list         the component list.
+        /// @throw AskapError   as for AskapComponentImager::project().
+        template <class T>
+        void update(const std::vector<casacore::ImageInterface<T>*>& images,
+                    const casacore::ComponentList& list);
+
+        /// Forget every component projected so far, e.g. before updating an
+        /// image which has been zeroed.
+        void reset(void);
+
+        /// @return the number of components the image currently holds
+        size_t nelements(void) const { return itsProjected.size(); }
+
+        /// @return the number of components added by the last update
+        size_t nAdded(void) const { return itsNAdded; }
+
+        /// @return the number of components subtracted by the last update
+        size_t nRemoved(void) const { return itsNRemoved; }
+
+    private:
+        typedef std::vector<double> Signature;
+        typedef std::multimap<Signature, casacore::SkyComponent> ComponentMap;
+
+        // Compare the list with the projected components, and make the list
+        // of components to project: the subtracted components (with negated
+        // flux) followed by the added ones
+        casacore::ComponentList diff(const casacore::ComponentList& list);
+
+        // @return the signature of a component
+        static Signature signature(const casacore::SkyComponent& c);
+
+        ProjectionOptions itsOptions;
+
+        // Private copies of the projected components, by signature
+        ComponentMap itsProjected;
+
+        size_t itsNAdded;
+        size_t itsNRemoved;
+};
+
+// Explicit instantiations exist for float and double types only
+extern template void
+IncrementalProjector::update(casacore::ImageInterface<float>&,
+                             const casacore::ComponentList&, const unsigned int);
+extern template void
+IncrementalProjector::update(casacore::ImageInterface<double>&,
+                             const casacore::ComponentList&, const unsigned int);
+extern template void
+IncrementalProjector::update(const std::vector<casacore::ImageInterface<float>*>&,
+                             const casacore::ComponentList&);
+extern template void
+IncrementalProjector::update(const std::vector<casacore::ImageInterface<double>*>&,
+                             const casacore::ComponentList&);
+
+}
+}
+
+#endif
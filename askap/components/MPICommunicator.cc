@@ -0,0 +1,60 @@
+/// @file MPICommunicator.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "MPICommunicator.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <vector>
+#include <mpi.h>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+
+using namespace askap;
+using namespace askap::components;
+
+MPICommunicator::MPICommunicator(MPI_Comm comm)
+    : itsComm(comm), itsRank(0), itsNRanks(1)
+{
+    ASKAPCHECK(MPI_Comm_rank(itsComm, &itsRank) == MPI_SUCCESS, "MPI_Comm_rank failed");
+    ASKAPCHECK(MPI_Comm_size(itsComm, &itsNRanks) == MPI_SUCCESS, "MPI_Comm_size failed");
+}
+
+void MPICommunicator::broadcast(std::vector<double>& values, const int root)
+{
+    unsigned long n = values.size();
+    ASKAPCHECK(MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG, root, itsComm) == MPI_SUCCESS,
+               "MPI_Bcast failed");
+    values.resize(n);
+    if (n > 0) {
+        ASKAPCHECK(MPI_Bcast(&values[0], static_cast<int>(n), MPI_DOUBLE, root, itsComm)
+                   == MPI_SUCCESS, "MPI_Bcast failed");
+    }
+}
@@ -0,0 +1,68 @@
+/// @file MPICommunicator.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_MPICOMMUNICATOR_H
+#define ASKAP_COMPONENTS_MPICOMMUNICATOR_H
+
+// System includes
+#include <vector>
+#include <mpi.h>
+
+// Local package includes
+#include "ProjectionCommunicator.h"
+
+namespace askap {
+namespace components {
+
+/// @brief A ProjectionCommunicator for the processes of an MPI communicator.
+///
+/// This is only built, and installed, when the package is built with MPI
+/// support (the MPI option). MPI must have been initialised, and must not be
+/// finalised before the communicator is destroyed.
+class MPICommunicator : public ProjectionCommunicator {
+    public:
+        /// Constructor
+        ///
+        /// @param[in] comm     the MPI communicator, which is not owned.
+        explicit MPICommunicator(MPI_Comm comm = MPI_COMM_WORLD);
+
+        virtual int rank(void) const { return itsRank; }
+
+        virtual int nRanks(void) const { return itsNRanks; }
+
+        /// @throw AskapError   if the broadcast fails.
+        virtual void broadcast(std::vector<double>& values, const int root);
+
+    private:
+        MPI_Comm itsComm;
+        int itsRank;
+        int itsNRanks;
+};
+
+}
+}
+
+#endif
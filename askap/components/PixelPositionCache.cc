@@ -0,0 +1,170 @@
+/// @file PixelPositionCache.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "PixelPositionCache.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <list>
+#include <utility>
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Quanta/MVDirection.h"
+#include "casacore/measures/Measures/MDirection.h"
+#include "casacore/coordinates/Coordinates/DirectionCoordinate.h"
+#include "components/ComponentModels/SkyComponent.h"
+#include "components/ComponentModels/ComponentList.h"
+#include "components/ComponentModels/ComponentShape.h"
+
+using namespace askap;
+using namespace askap::components;
+using namespace casacore;
+
+PixelPositionCache::PixelPositionCache(const size_t maxEntries)
+    : itsMaxEntries(maxEntries), itsHits(0), itsMisses(0)
+{
+    ASKAPCHECK(maxEntries > 0, "Cache must hold at least one entry");
+}
+
+const std::vector<double>& PixelPositionCache::positions(const casacore::ComponentList& list,
+        const casacore::DirectionCoordinate& dirCoord)
+{
+    return positions(list, dirCoord, allComponents(list));
+}
+
+const std::vector<double>& PixelPositionCache::positions(const casacore::ComponentList& list,
+        const casacore::DirectionCoordinate& dirCoord,
+        const std::vector<casacore::uInt>& candidates)
+{
+    getDirections(list, itsDirections);
+    const std::list<Entry>::iterator it = find(dirCoord, candidates);
+    if (it != itsEntries.end()) {
+        itsEntries.splice(itsEntries.begin(), itsEntries, it);
+        ++itsHits;
+        return itsEntries.front().positions;
+    }
+
+    // Convert world position to pixel position
+    Entry entry;
+    entry.dirCoord = dirCoord;
+    entry.candidates = candidates;
+    entry.positions.resize(2 * candidates.size());
+    Vector<Double> pixelPosition(2);
+    for (size_t n = 0; n < candidates.size(); ++n) {
+        ASKAPCHECK(candidates[n] < list.nelements(), "Component index out of range");
+        const bool toPixelOk = dirCoord.toPixel(pixelPosition,
+                                                list.component(candidates[n]).shape().refDirection());
+        ASKAPCHECK(toPixelOk, "toPixel failed");
+        entry.positions[2 * n] = pixelPosition(0);
+        entry.positions[2 * n + 1] = pixelPosition(1);
+    }
+    ++itsMisses;
+    add(entry);
+    return itsEntries.front().positions;
+}
+
+bool PixelPositionCache::contains(const casacore::ComponentList& list,
+                                  const casacore::DirectionCoordinate& dirCoord)
+{
+    getDirections(list, itsDirections);
+    return find(dirCoord, allComponents(list)) != itsEntries.end();
+}
+
+void PixelPositionCache::insert(const casacore::ComponentList& list,
+                                const casacore::DirectionCoordinate& dirCoord,
+                                const std::vector<double>& positions)
+{
+    ASKAPCHECK(positions.size() == 2 * list.nelements(),
+               "There must be two pixel positions per component");
+    getDirections(list, itsDirections);
+    const std::list<Entry>::iterator it = find(dirCoord, allComponents(list));
+    if (it != itsEntries.end()) {
+        itsEntries.erase(it);
+    }
+    Entry entry;
+    entry.dirCoord = dirCoord;
+    entry.candidates = itsAllComponents;
+    entry.positions = positions;
+    add(entry);
+}
+
+void PixelPositionCache::clear(void)
+{
+    itsEntries.clear();
+}
+
+std::list<PixelPositionCache::Entry>::iterator
+PixelPositionCache::find(const casacore::DirectionCoordinate& dirCoord,
+                         const std::vector<casacore::uInt>& candidates)
+{
+    // An exact (zero tolerance) match of the coordinate is required
+    for (std::list<Entry>::iterator it = itsEntries.begin(); it != itsEntries.end(); ++it) {
+        if (it->directions == itsDirections && it->candidates == candidates
+                && it->dirCoord.near(dirCoord, 0.0)) {
+            return it;
+        }
+    }
+    return itsEntries.end();
+}
+
+void PixelPositionCache::add(Entry& entry)
+{
+    entry.directions.swap(itsDirections);
+    itsEntries.push_front(std::move(entry));
+    if (itsEntries.size() > itsMaxEntries) {
+        itsEntries.pop_back();
+    }
+}
+
+void PixelPositionCache::getDirections(const casacore::ComponentList& list,
+                                       std::vector<double>& directions)
+{
+    directions.resize(4 * list.nelements());
+    for (uInt i = 0; i < list.nelements(); ++i) {
+        const MDirection& dir = list.component(i).shape().refDirection();
+        const MVDirection& value = dir.getValue();
+        directions[4 * i] = value(0);
+        directions[4 * i + 1] = value(1);
+        directions[4 * i + 2] = value(2);
+        directions[4 * i + 3] = dir.getRef().getType();
+    }
+}
+
+const std::vector<casacore::uInt>& PixelPositionCache::allComponents(const casacore::ComponentList& list)
+{
+    itsAllComponents.resize(list.nelements());
+    for (uInt i = 0; i < list.nelements(); ++i) {
+        itsAllComponents[i] = i;
+    }
+    return itsAllComponents;
+}
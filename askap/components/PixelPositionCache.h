@@ -0,0 +1,182 @@
+/// @file PixelPositionCache.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_PIXELPOSITIONCACHE_H
+#define ASKAP_COMPONENTS_PIXELPOSITIONCACHE_H
+
+// System includes
+#include <list>
+#include <vector>
+#include <cstddef>
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+#include "casacore/coordinates/Coordinates/DirectionCoordinate.h"
+#include "casarest/components/ComponentModels/ComponentList.h"
+
+namespace askap {
+namespace components {
+
+/// @brief Caches the pixel position of every component in a list for a
+/// given DirectionCoordinate.
+///
+/// Converting component directions to pixel positions is one of the more
+/// expensive parts of projecting a large component list. When the same list
+/// is projected several times onto images with the same direction coordinate
+/// (for instance the taylor terms of one beam) the cache allows the
+/// conversion to be done once. Entries for several coordinates (for instance
+/// one per beam) are kept, and the least recently used entry is discarded
+/// once the cache is full.
+///
+/// An entry is only used if its direction coordinate is identical to the
+/// requested one, and the direction (and reference frame) of every component
+/// matches that of the list the entry was made from. Checking the directions
+/// is much cheaper than converting them, and means a list which has been
+/// modified is never given stale positions.
+///
+/// The positions of a subset of the list (for instance the candidates found
+/// by a ComponentIndex) can be cached instead, so components which cannot be
+/// converted to pixels (such as those on the far side of the sky from a SIN
+/// projection) are not converted at all. Such an entry is only used for the
+/// same subset.
+///
+/// Thread Safety:
+/// This class is not thread safe. A cache must not be used by concurrent
+/// calls to AskapComponentImager::project().
+class PixelPositionCache {
+    public:
+        /// Constructor
+        ///
+        /// @param[in] maxEntries   the number of (list, coordinate) pairs to
+        ///                         retain. Must be at least one.
+        explicit PixelPositionCache(const size_t maxEntries = 8);
+
+        /// Get the pixel positions of the components of a list, converting
+        /// them if they are not already cached.
+        ///
+        /// @param[in] list     the component list.
+        /// @param[in] dirCoord the direction coordinate of the image.
+        /// @return the (lat, lon) pixel position of component i in elements
+        ///         2i and 2i+1. The reference is valid until the next call.
+        /// @throw AskapError   if a direction cannot be converted.
+        const std::vector<double>& positions(const casacore::ComponentList& list,
+                                             const casacore::DirectionCoordinate& dirCoord);
+
+        /// Get the pixel positions of a subset of the components of a list,
+        /// converting them if they are not already cached.
+        ///
+        /// @param[in] list         the component list.
+        /// @param[in] dirCoord     the direction coordinate of the image.
+        /// @param[in] candidates   the indices of the components in the
+        ///                         subset, in list order.
+        /// @return the (lat, lon) pixel position of component candidates[n]
+        ///         in elements 2n and 2n+1. The reference is valid until the
+        ///         next call.
+        /// @throw AskapError   if a direction in the subset cannot be
+        ///                     converted.
+        const std::vector<double>& positions(const casacore::ComponentList& list,
+                                             const casacore::DirectionCoordinate& dirCoord,
+                                             const std::vector<casacore::uInt>& candidates);
+
+        /// @return true if the positions of the list for the given direction
+        ///         coordinate are cached. This does not change the order in
+        ///         which entries are discarded.
+        bool contains(const casacore::ComponentList& list,
+                      const casacore::DirectionCoordinate& dirCoord);
+
+        /// Add the positions of a list which were converted elsewhere, for
+        /// instance by another process. Subsequent calls to positions()
+        /// for the list and coordinate are satisfied from the cache.
+        ///
+        /// @param[in] list         the component list.
+        /// @param[in] dirCoord     the direction coordinate of the image.
+        /// @param[in] positions    the (lat, lon) pixel position of
+        ///                         component i in elements 2i and 2i+1.
+        /// @throw AskapError   if there are not two positions per component.
+        void insert(const casacore::ComponentList& list,
+                    const casacore::DirectionCoordinate& dirCoord,
+                    const std::vector<double>& positions);
+
+        /// @return the number of calls to positions() satisfied from the cache
+        size_t hits(void) const { return itsHits; }
+
+        /// @return the number of calls to positions() which converted the list
+        size_t misses(void) const { return itsMisses; }
+
+        /// Discard all entries
+        void clear(void);
+
+    private:
+        struct Entry {
+            casacore::DirectionCoordinate dirCoord;
+
+            // The components whose positions are held, in list order
+            std::vector<casacore::uInt> candidates;
+
+            // Direction cosines and reference type of each component,
+            // indexed (4 * i + k)
+            std::vector<double> directions;
+
+            // Pixel positions, indexed (2 * i + k)
+            std::vector<double> positions;
+        };
+
+        // @return the entry for the directions in itsDirections, the given
+        // coordinate and the given components, or itsEntries.end() if there
+        // is none
+        std::list<Entry>::iterator find(const casacore::DirectionCoordinate& dirCoord,
+                                        const std::vector<casacore::uInt>& candidates);
+
+        // Add an entry as the most recently used, discarding the least
+        // recently used if the cache is full
+        void add(Entry& entry);
+
+        // Get the direction cosines and reference type of every component
+        static void getDirections(const casacore::ComponentList& list,
+                                  std::vector<double>& directions);
+
+        // Fill itsAllComponents with the index of every component of a list
+        const std::vector<casacore::uInt>& allComponents(const casacore::ComponentList& list);
+
+        const size_t itsMaxEntries;
+
+        // Most recently used first
+        std::list<Entry> itsEntries;
+
+        // Scratch space for the directions of the list being looked up
+        std::vector<double> itsDirections;
+
+        // Scratch space for the indices of every component of a list
+        std::vector<casacore::uInt> itsAllComponents;
+
+        size_t itsHits;
+        size_t itsMisses;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,76 @@
+/// @file ProjectionCommunicator.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_PROJECTIONCOMMUNICATOR_H
+#define ASKAP_COMPONENTS_PROJECTIONCOMMUNICATOR_H
+
+// System includes
+#include <vector>
+
+namespace askap {
+namespace components {
+
+/// @brief The communication needed by DistributedProjector, between the
+/// processes (ranks) which share the projection of a component list.
+///
+/// This keeps the projector independent of a particular message passing
+/// library. MPICommunicator implements it with MPI (when built with MPI
+/// support), and SerialCommunicator for a single process.
+class ProjectionCommunicator {
+    public:
+        /// Destructor
+        virtual ~ProjectionCommunicator() {}
+
+        /// @return the rank of this process, in the range [0, nRanks())
+        virtual int rank(void) const = 0;
+
+        /// @return the number of processes
+        virtual int nRanks(void) const = 0;
+
+        /// Broadcast values from one process to all of the others. This is
+        /// a collective operation, so must be called by every process.
+        ///
+        /// @param[inout] values    the values to send on the root process,
+        ///                         and the values received on the others
+        ///                         (which are resized to fit).
+        /// @param[in] root         the rank of the sending process.
+        virtual void broadcast(std::vector<double>& values, const int root) = 0;
+};
+
+/// @brief A ProjectionCommunicator for a single process, which has rank 0.
+class SerialCommunicator : public ProjectionCommunicator {
+    public:
+        virtual int rank(void) const { return 0; }
+
+        virtual int nRanks(void) const { return 1; }
+
+        virtual void broadcast(std::vector<double>&, const int) {}
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,213 @@
+/// @file ProjectionOptions.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_PROJECTIONOPTIONS_H
+#define ASKAP_COMPONENTS_PROJECTIONOPTIONS_H
+
+// System includes
+#include <cstddef>
+#include <vector>
+
+// ASKAPsoft includes
+#include "casacore/scimath/Mathematics/GaussianBeam.h"
+
+namespace askap {
+namespace components {
+
+class ComponentIndex;
+class FootprintCache;
+class PixelPositionCache;
+struct ProjectionStats;
+class SpectralModel;
+
+/// @brief Options which control how AskapComponentImager::project() renders
+/// a component list onto an image.
+///
+/// The default constructed options reproduce the behaviour of the serial
+/// implementation.
+struct ProjectionOptions {
+
+    /// The methods available for integrating a gaussian over a pixel
+    enum GaussianKernel {
+        /// Sample the gaussian on a regular grid of at least 33x33 points per
+        /// pixel, and integrate with Simpson's rule
+        SIMPSON,
+
+        /// Integrate analytically along one pixel axis (as a difference of
+        /// error functions) and with Gauss-Legendre quadrature along the
+        /// other. When the gaussian's axes are aligned with the pixel grid
+        /// (position angle of 0 or 90 degrees) the integral is exact. Otherwise
+        /// the quadrature is sized by the minor axis, and the absolute error
+        /// in each pixel is below 1e-8 of the component flux.
+        ANALYTIC,
+
+        /// As for SIMPSON, but with the samples evaluated in single precision,
+        /// which is about twice as fast. The relative error in each pixel is
+        /// of order 1e-6, so this is intended for single precision images.
+        SIMPSON_SINGLE
+    };
+
+    /// The policies available for truncating a gaussian's footprint
+    enum CutoffPolicy {
+        /// Extend the footprint along the major axis until the gaussian falls
+        /// below machine epsilon (for the image's pixel type), and use that
+        /// distance for both pixel axes
+        MACHINE_EPSILON,
+
+        /// Truncate at the contour where the gaussian falls below cutoffValue
+        /// times its peak value
+        RELATIVE_TO_PEAK,
+
+        /// Truncate at the contour where the gaussian, in the brightest image
+        /// plane, falls below cutoffValue Jy per pixel
+        ABSOLUTE_FLUX,
+
+        /// Truncate at the contour cutoffValue standard deviations from the
+        /// centre
+        N_SIGMA
+    };
+
+    /// Constructor
+    /// Sets all options to their default values.
+    ProjectionOptions() : nThreads(1), gaussianKernel(SIMPSON),
+        cutoffPolicy(MACHINE_EPSILON), cutoffValue(0.0), positionCache(0),
+        componentIndex(0), spectralModels(0), channelBlockMemory(0), stats(0),
+        footprintCache(0), compensatedSummation(false), writeQueueDepth(0) {}
+
+    /// The number of threads used to render the image. A value of zero
+    /// will use one thread per hardware core.
+    ///
+    /// The image produced does not depend on the number of threads. Each
+    /// image plane is only ever written by a single thread, and the
+    /// components are always added in list order, so the result is
+    /// identical (bit for bit) to the serial case.
+    unsigned int nThreads;
+
+    /// The method used to integrate gaussian components over each pixel.
+    /// Gaussians with a minor axis of less than 1e-3 pixels are always
+    /// treated as one dimensional, regardless of this setting.
+    GaussianKernel gaussianKernel;
+
+    /// The policy used to truncate gaussian components. Other than for
+    /// MACHINE_EPSILON, the footprint is the bounding box of the elliptical
+    /// contour, so it is narrower along the minor axis.
+    CutoffPolicy cutoffPolicy;
+
+    /// The parameter of the cutoff policy. This is a fraction in the
+    /// range (0, 1) for RELATIVE_TO_PEAK, a flux in Jy per pixel for
+    /// ABSOLUTE_FLUX and a number of standard deviations for N_SIGMA. It
+    /// is not used for MACHINE_EPSILON.
+    double cutoffValue;
+
+    /// An optional cache of component pixel positions, owned by the caller.
+    /// When set, the list is only converted to pixel positions the first
+    /// time it is projected onto an image with a given direction coordinate.
+    /// With a componentIndex only the positions of its candidates are cached.
+    PixelPositionCache* positionCache;
+
+    /// An optional spatial index of the component list, owned by the caller.
+    /// When set, only the components which may contribute to the image are
+    /// visited. For the MACHINE_EPSILON and ABSOLUTE_FLUX policies components
+    /// are culled where their peak is more than 1e30 times the cutoff. The
+    /// index must have been built from the list being projected.
+    const ComponentIndex* componentIndex;
+
+    /// Optional spectral models which replace those of the components,
+    /// owned by the caller. This has one entry per component of the list
+    /// being projected, and a null entry keeps the component's own model.
+    /// Any spectral curvature (e.g. of a CurvedSpectrum) is used both for
+    /// the spectral variation and for taylor term 2.
+    const std::vector<const SpectralModel*>* spectralModels;
+
+    /// The memory budget, in bytes, for rendering in channel blocks. When
+    /// zero (the default) the footprints are added to the images a plane at
+    /// a time. Otherwise the images are rendered a block of channels at a
+    /// time: each block is read once, every component is added to it in
+    /// memory, and it is written back once, so the images are accessed
+    /// sequentially. The block is sized to a whole number of the image's
+    /// preferred cursor shape along the frequency axis, with all the blocks
+    /// of every taylor term image fitting within the budget. The result is
+    /// identical to that of the default mode, but the footprints are
+    /// evaluated once per channel block rather than once overall.
+    size_t channelBlockMemory;
+
+    /// Optional statistics, owned by the caller. When set, the counts and
+    /// times of the projection are added to them. When null (the default)
+    /// none are gathered, and the clock is never read.
+    ProjectionStats* stats;
+
+    /// Optional restoring beams. When set the components are rendered
+    /// already convolved with the beam, normalised to a peak of one, so the
+    /// images are in Jy/beam as for a restored model image. A point
+    /// becomes the beam, and a gaussian the gaussian whose covariance is the
+    /// sum of its own and that of the beam, so no separate convolution of the
+    /// images is needed. The position angles are as for a GaussianShape, and
+    /// the cutoff policy applies to the convolved gaussian.
+    ///
+    /// This holds either a single beam for every channel, or one beam per
+    /// channel. Channels with the same beam as the previous channel share
+    /// their footprints, so a cube whose beam changes with every channel
+    /// evaluates each footprint once per channel. Disk components cannot be
+    /// convolved, and a sparse model only supports a single beam.
+    std::vector<casacore::GaussianBeam> restoringBeams;
+
+    /// An optional cache of gaussian footprints, owned by the caller. When
+    /// set, gaussians which share a shape (for instance points restored
+    /// with the same beam) share a footprint, which is only integrated the
+    /// first time it is needed. The centre of each gaussian is rounded to
+    /// the cache's subpixel grid, including the first. The cache may be kept
+    /// across projections.
+    FootprintCache* footprintCache;
+
+    /// Add the footprints to the images with compensated (Kahan)
+    /// summation, which carries the rounding error of each addition over to
+    /// the next. The result is then close to that of summing in extended
+    /// precision, even where a great many faint components overlap in a
+    /// single precision image. The images are rendered in channel blocks,
+    /// with a compensation term for every pixel of the block which counts
+    /// towards the channelBlockMemory. If that is zero, a block of one
+    /// cursor shape along the frequency axis per thread is used. Sparse
+    /// models are not compensated.
+    bool compensatedSummation;
+
+    /// The number of rendered channel blocks which may be queued for writing
+    /// while the next block is rendered. When zero (the default) each block
+    /// is read, rendered and written in turn. Otherwise a separate thread
+    /// writes each rendered block to the images and then reads the block
+    /// which will next use its buffers, so the image I/O (e.g. of a
+    /// PagedImage) overlaps the rendering. Rendering waits when
+    /// writeQueueDepth blocks are already queued. The images are rendered in
+    /// channel blocks, and the buffers of every queued block count towards
+    /// the channelBlockMemory, as for compensatedSummation. The images must
+    /// not be accessed by any other thread during the projection. Sparse
+    /// models are not affected.
+    unsigned int writeQueueDepth;
+};
+
+}
+}
+
+#endif
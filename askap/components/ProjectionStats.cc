@@ -0,0 +1,89 @@
+/// @file ProjectionStats.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "ProjectionStats.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <algorithm>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapLogging.h"
+
+ASKAP_LOGGER(logger, ".ProjectionStats");
+
+using namespace askap;
+using namespace askap::components;
+
+namespace {
+
+const char* const SHAPE_NAMES[ProjectionStats::N_SHAPES] = {"point", "gaussian", "disk"};
+
+}
+
+void ProjectionStats::reset()
+{
+    std::fill(rendered, rendered + N_SHAPES, 0);
+    std::fill(culled, culled + N_SHAPES, 0);
+    std::fill(footprintPixels, footprintPixels + N_SHAPES, 0);
+    std::fill(pixelsEvaluated, pixelsEvaluated + N_KERNELS, 0);
+    footprintCacheHits = 0;
+    footprintCacheMisses = 0;
+    coordinateSeconds = 0.0;
+    fluxSeconds = 0.0;
+    kernelSeconds = 0.0;
+    imageSeconds = 0.0;
+}
+
+double ProjectionStats::meanFootprint(const Shape shape) const
+{
+    return (rendered[shape] > 0)
+           ? static_cast<double>(footprintPixels[shape]) / rendered[shape] : 0.0;
+}
+
+void ProjectionStats::log() const
+{
+    for (int shape = 0; shape < N_SHAPES; ++shape) {
+        ASKAPLOG_INFO_STR(logger, "Rendered " << rendered[shape] << " and culled "
+                          << culled[shape] << " " << SHAPE_NAMES[shape]
+                          << " components, with a mean footprint of "
+                          << meanFootprint(static_cast<Shape>(shape)) << " pixels");
+    }
+    ASKAPLOG_INFO_STR(logger, "Pixels evaluated: " << pixelsEvaluated[LINE_GAUSSIAN]
+                      << " for 1D gaussians, " << pixelsEvaluated[GAUSSIAN_2D]
+                      << " for 2D gaussians, " << pixelsEvaluated[DISK_OVERLAP]
+                      << " for disks");
+    if (footprintCacheHits + footprintCacheMisses > 0) {
+        ASKAPLOG_INFO_STR(logger, "Footprint cache: " << footprintCacheHits << " hits and "
+                          << footprintCacheMisses << " misses");
+    }
+    ASKAPLOG_INFO_STR(logger, "Time spent: " << coordinateSeconds << "s on coordinates, "
+                      << fluxSeconds << "s on fluxes, " << kernelSeconds
+                      << "s on kernels, " << imageSeconds << "s on image access");
+}
@@ -0,0 +1,131 @@
+/// @file ProjectionStats.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_PROJECTIONSTATS_H
+#define ASKAP_COMPONENTS_PROJECTIONSTATS_H
+
+// System includes
+#include <cstddef>
+
+namespace askap {
+namespace components {
+
+/// @brief Counters and timers describing where AskapComponentImager::project()
+/// spends its time.
+///
+/// The statistics are only gathered when ProjectionOptions::stats points to
+/// an instance, so there is no cost otherwise. Each projection adds to the
+/// counts, so one instance can gather the totals for a sequence of
+/// projections (e.g. of the beams of an observation) until reset().
+///
+/// Thread Safety:
+/// An instance must not be shared by concurrent calls to project().
+struct ProjectionStats {
+
+    /// The component shapes which are counted separately
+    enum Shape {
+        POINT,
+        GAUSSIAN,
+        DISK,
+        N_SHAPES
+    };
+
+    /// The methods of evaluating a footprint, for which the pixels
+    /// evaluated are counted separately
+    enum Kernel {
+        /// A gaussian with a minor axis below 1e-3 pixels, evaluated as a
+        /// line (see AskapComponentImager::evaluateGaussian1D())
+        LINE_GAUSSIAN,
+
+        /// A gaussian integrated over the pixel in two dimensions
+        GAUSSIAN_2D,
+
+        /// The area of overlap of a disk and the pixel
+        DISK_OVERLAP,
+
+        N_KERNELS
+    };
+
+    /// Constructor
+    /// Sets all counts and times to zero.
+    ProjectionStats() { reset(); }
+
+    /// Set all counts and times to zero
+    void reset();
+
+    /// @return the mean number of pixels in the footprint of each rendered
+    ///         component of the given shape, or zero if there were none.
+    double meanFootprint(const Shape shape) const;
+
+    /// Write a summary of the statistics to the log, at INFO level
+    void log() const;
+
+    /// The number of components rendered onto the image, for each shape
+    size_t rendered[N_SHAPES];
+
+    /// The number of components culled, for each shape. These were either
+    /// excluded by the component index, fell entirely off the image or had
+    /// no flux in any plane.
+    size_t culled[N_SHAPES];
+
+    /// The total number of pixels in the footprints of the rendered
+    /// components, for each shape. For gaussians this is the extent found
+    /// by the cutoff policy.
+    size_t footprintPixels[N_SHAPES];
+
+    /// The number of pixels evaluated by each kernel. Footprints are
+    /// evaluated once per channel block, so in the channel block mode this
+    /// can be larger than footprintPixels.
+    size_t pixelsEvaluated[N_KERNELS];
+
+    /// The number of gaussian footprints shared with an earlier component,
+    /// either from the footprint cache or from a component of the same
+    /// projection, when a cache is used
+    size_t footprintCacheHits;
+
+    /// The number of gaussian footprints which were integrated and added to
+    /// the footprint cache, when a cache is used
+    size_t footprintCacheMisses;
+
+    /// Time spent converting component directions to pixel positions and
+    /// sizing footprints, in seconds
+    double coordinateSeconds;
+
+    /// Time spent finding the flux of each component in each plane, in seconds
+    double fluxSeconds;
+
+    /// Time spent evaluating footprints, in seconds
+    double kernelSeconds;
+
+    /// Time spent reading, adding footprints to and writing the images (or
+    /// the sparse model), in seconds
+    double imageSeconds;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,45 @@
+/// @file Simd.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_SIMD_H
+#define ASKAP_COMPONENTS_SIMD_H
+
+// Loops marked with ASKAP_SIMD have independent iterations and no function
+// calls, so are safe to vectorise. With OpenMP SIMD support the compiler is
+// told so explicitly, otherwise it is left to the auto-vectoriser. Loops
+// marked with ASKAP_SIMD_SUM are sums, which may then be reordered.
+//
+// This header is internal to the package, so is only included by ".cc" files.
+#ifdef HAVE_OPENMP_SIMD
+#define ASKAP_SIMD _Pragma("omp simd")
+#define ASKAP_STRINGIFY(x) #x
+#define ASKAP_SIMD_SUM(var) _Pragma(ASKAP_STRINGIFY(omp simd reduction(+:var)))
+#else
+#define ASKAP_SIMD
+#define ASKAP_SIMD_SUM(var)
+#endif
+
+#endif
@@ -0,0 +1,193 @@
+/// @file SparseModel.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "SparseModel.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <algorithm>
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/IPosition.h"
+#include "casacore/casa/Arrays/Array.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "casacore/coordinates/Coordinates/CoordinateUtil.h"
+#include "casacore/coordinates/Coordinates/CoordinateSystem.h"
+#include "casacore/images/Images/ImageInterface.h"
+
+using namespace askap;
+using namespace askap::components;
+using namespace casacore;
+
+template <class T>
+SparseModel<T>::SparseModel(const casacore::IPosition& shape,
+                            const casacore::CoordinateSystem& coords)
+    : itsShape(shape), itsCoords(coords)
+{
+    const Vector<Int> dirAxes = CoordinateUtil::findDirectionAxes(coords);
+    ASKAPCHECK(dirAxes.nelements() == 2,
+               "Coordinate system has unsupported number of direction axes");
+    ASKAPCHECK(shape.nelements() == coords.nPixelAxes(),
+               "Shape does not match the coordinate system");
+    itsLatAxis = dirAxes(0);
+    itsLonAxis = dirAxes(1);
+    itsFreqAxis = CoordinateUtil::findSpectralAxis(coords);
+    Vector<Stokes::StokesTypes> stokes;
+    itsPolAxis = CoordinateUtil::findStokesAxis(stokes, coords);
+
+    itsNLat = shape(itsLatAxis);
+    itsNLon = shape(itsLonAxis);
+    itsNChannels = (itsFreqAxis >= 0) ? shape(itsFreqAxis) : 1;
+    itsNPols = (itsPolAxis >= 0) ? shape(itsPolAxis) : 1;
+    itsPlanes.resize(itsNChannels * itsNPols);
+}
+
+template <class T>
+void SparseModel<T>::compact(void)
+{
+    std::vector<size_t> order;
+    for (size_t p = 0; p < itsPlanes.size(); ++p) {
+        Plane& plane = itsPlanes[p];
+        if (plane.compacted) {
+            continue;
+        }
+
+        // A stable sort, so the entries of a pixel are summed in the order
+        // they were added
+        const std::vector<uInt>& pixels = plane.pixels;
+        order.resize(pixels.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&pixels](size_t a, size_t b) { return pixels[a] < pixels[b]; });
+
+        // Each entry is added and then rounded to T, as it would be when
+        // added to a dense image
+        std::vector<uInt> newPixels;
+        std::vector<double> newValues;
+        for (size_t i = 0; i < order.size(); ) {
+            const uInt pixel = pixels[order[i]];
+            T sum = 0;
+            for (; i < order.size() && pixels[order[i]] == pixel; ++i) {
+                sum = static_cast<T>(sum + plane.values[order[i]]);
+            }
+            if (sum != T(0)) {
+                newPixels.push_back(pixel);
+                newValues.push_back(sum);
+            }
+        }
+        plane.pixels.swap(newPixels);
+        plane.values.swap(newValues);
+        plane.compacted = true;
+    }
+}
+
+template <class T>
+size_t SparseModel<T>::nonZeros(void) const
+{
+    size_t total = 0;
+    for (size_t p = 0; p < itsPlanes.size(); ++p) {
+        total += itsPlanes[p].pixels.size();
+    }
+    return total;
+}
+
+template <class T>
+void SparseModel<T>::addTo(casacore::ImageInterface<T>& image) const
+{
+    ASKAPCHECK(image.shape().isEqual(itsShape), "Image shape does not match the model");
+
+    Array<T> buffer;
+    for (uInt chan = 0; chan < itsNChannels; ++chan) {
+        for (uInt pol = 0; pol < itsNPols; ++pol) {
+            const Plane& plane = itsPlanes[chan * itsNPols + pol];
+            if (plane.pixels.empty()) {
+                continue;
+            }
+
+            // The slice covers the rows spanned by the entries
+            const uInt firstRow = *std::min_element(plane.pixels.begin(),
+                                                    plane.pixels.end()) / itsNLat;
+            const uInt lastRow = *std::max_element(plane.pixels.begin(),
+                                                   plane.pixels.end()) / itsNLat;
+            IPosition start(itsShape.nelements(), 0);
+            IPosition shape(itsShape);
+            start(itsLonAxis) = firstRow;
+            shape(itsLonAxis) = lastRow - firstRow + 1;
+            if (itsFreqAxis >= 0) {
+                start(itsFreqAxis) = chan;
+                shape(itsFreqAxis) = 1;
+            }
+            if (itsPolAxis >= 0) {
+                start(itsPolAxis) = pol;
+                shape(itsPolAxis) = 1;
+            }
+            image.getSlice(buffer, start, shape);
+            buffer.unique();
+
+            // Offsets between adjacent elements of the slice along each axis
+            IPosition strides(shape.nelements());
+            ssize_t stride = 1;
+            for (uInt axis = 0; axis < shape.nelements(); ++axis) {
+                strides(axis) = stride;
+                stride *= shape(axis);
+            }
+            const ssize_t latStride = strides(itsLatAxis);
+            const ssize_t lonStride = strides(itsLonAxis);
+
+            Bool deleteIt;
+            T* data = buffer.getStorage(deleteIt);
+            for (size_t i = 0; i < plane.pixels.size(); ++i) {
+                const uInt lat = plane.pixels[i] % itsNLat;
+                const uInt row = plane.pixels[i] / itsNLat - firstRow;
+                T& pixel = data[lat * latStride + row * lonStride];
+                pixel = static_cast<T>(pixel + plane.values[i]);
+            }
+            buffer.putStorage(data, deleteIt);
+            image.putSlice(buffer, start);
+        }
+    }
+}
+
+template <class T>
+void SparseModel<T>::clear(void)
+{
+    for (size_t p = 0; p < itsPlanes.size(); ++p) {
+        itsPlanes[p] = Plane();
+    }
+}
+
+// Explicit instantiation
+template class askap::components::SparseModel<float>;
+template class askap::components::SparseModel<double>;
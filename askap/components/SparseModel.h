@@ -0,0 +1,181 @@
+/// @file SparseModel.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_SPARSEMODEL_H
+#define ASKAP_COMPONENTS_SPARSEMODEL_H
+
+// System includes
+#include <vector>
+#include <cstddef>
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/IPosition.h"
+#include "casacore/coordinates/Coordinates/CoordinateSystem.h"
+#include "casacore/images/Images/ImageInterface.h"
+
+namespace askap {
+namespace components {
+
+/// @brief A sparse model image, which holds only the pixels a component
+/// list contributes to.
+///
+/// The model has the shape and coordinate system of a (dense) image, but
+/// each image plane (a single channel and polarisation) holds a list of
+/// (pixel, value) entries rather than every pixel. A pixel is identified by
+/// its index (lat + lon * nLat) within the plane. For a sky dominated by
+/// point components the model is orders of magnitude smaller than the image,
+/// and there is no zero fill or I/O of empty pixels.
+///
+/// Entries are appended by add(). A pixel may then have more than one entry,
+/// until compact() sorts each plane by pixel index and sums the entries of
+/// each pixel (in the order they were added), so each plane is in
+/// compressed row order. The model can be added to a dense image at any time
+/// with addTo().
+///
+/// The entries are held in double precision, as the values added to a dense
+/// image are. compact() rounds the sum of a pixel to T after each entry is
+/// added, just as each value is rounded when added to a pixel of a dense
+/// image of type T, so a compacted model added to an empty image gives
+/// exactly the dense result.
+///
+/// Thread Safety:
+/// add() may be called concurrently for different planes. Nothing else may
+/// be called concurrently with a call which modifies the model.
+template <class T>
+class SparseModel {
+    public:
+        /// Constructor
+        /// Creates an empty model.
+        ///
+        /// @param[in] shape    the shape of the image being modelled.
+        /// @param[in] coords   the coordinate system of the image being
+        ///                     modelled. This must have a direction
+        ///                     coordinate with two pixel axes.
+        SparseModel(const casacore::IPosition& shape,
+                    const casacore::CoordinateSystem& coords);
+
+        /// @return the shape of the image being modelled
+        const casacore::IPosition& shape(void) const { return itsShape; }
+
+        /// @return the coordinate system of the image being modelled
+        const casacore::CoordinateSystem& coordinates(void) const { return itsCoords; }
+
+        /// @return the number of pixels along the latitude axis
+        casacore::uInt nLat(void) const { return itsNLat; }
+
+        /// @return the number of pixels along the longitude axis
+        casacore::uInt nLon(void) const { return itsNLon; }
+
+        /// @return the number of channels (one if there is no spectral axis)
+        casacore::uInt nChannels(void) const { return itsNChannels; }
+
+        /// @return the number of polarisations (one if there is no Stokes axis)
+        casacore::uInt nPols(void) const { return itsNPols; }
+
+        /// Add a value to a pixel.
+        ///
+        /// @param[in] chan     the channel.
+        /// @param[in] pol      the polarisation.
+        /// @param[in] lat      the pixel on the latitude axis.
+        /// @param[in] lon      the pixel on the longitude axis.
+        /// @param[in] value    the value to add.
+        void add(const casacore::uInt chan, const casacore::uInt pol,
+                 const casacore::uInt lat, const casacore::uInt lon, const double value)
+        {
+            Plane& plane = itsPlanes[chan * itsNPols + pol];
+            plane.pixels.push_back(lat + lon * itsNLat);
+            plane.values.push_back(value);
+            plane.compacted = false;
+        }
+
+        /// Sort the entries of each plane by pixel index, and sum the entries
+        /// of each pixel, rounding to T after each. Pixels which sum to zero
+        /// are removed.
+        void compact(void);
+
+        /// @return the number of entries, over all planes
+        size_t nonZeros(void) const;
+
+        /// @return the pixel index, (lat + lon * nLat), of each entry of a
+        ///         plane. These are in ascending order once compacted.
+        const std::vector<casacore::uInt>& pixels(const casacore::uInt chan,
+                const casacore::uInt pol) const
+        {
+            return itsPlanes[chan * itsNPols + pol].pixels;
+        }
+
+        /// @return the value of each entry of a plane. Once compacted these
+        ///         are values of type T.
+        const std::vector<double>& values(const casacore::uInt chan, const casacore::uInt pol) const
+        {
+            return itsPlanes[chan * itsNPols + pol].values;
+        }
+
+        /// Add the model to a dense image. Only the rows (along the latitude
+        /// axis) of each plane which have entries are read and written.
+        ///
+        /// @param[inout] image the image, which must have the model's shape.
+        void addTo(casacore::ImageInterface<T>& image) const;
+
+        /// Remove all entries
+        void clear(void);
+
+    private:
+        // The entries of one plane
+        struct Plane {
+            Plane() : compacted(true) {}
+            std::vector<casacore::uInt> pixels;
+            std::vector<double> values;
+            bool compacted;
+        };
+
+        casacore::IPosition itsShape;
+        casacore::CoordinateSystem itsCoords;
+
+        // Pixel axis numbers, negative if the axis is not present
+        casacore::Int itsLatAxis;
+        casacore::Int itsLonAxis;
+        casacore::Int itsFreqAxis;
+        casacore::Int itsPolAxis;
+
+        casacore::uInt itsNLat;
+        casacore::uInt itsNLon;
+        casacore::uInt itsNChannels;
+        casacore::uInt itsNPols;
+
+        // Indexed (chan * nPols + pol)
+        std::vector<Plane> itsPlanes;
+};
+
+// Explicit instantiations exist for float and double types only
+extern template class SparseModel<float>;
+extern template class SparseModel<double>;
+
+}
+}
+
+#endif
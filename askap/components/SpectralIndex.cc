@@ -32,6 +32,7 @@
 
 // System includes
 #include <cmath>
+#include <algorithm>
 
 // ASKAPsoft includes
 #include "askap/askap/AskapError.h"
@@ -65,6 +66,20 @@ double SpectralIndex::sample(const casacore::MFrequency& centerFrequency) const
             itsSpectralIndex);
 }
 
+void SpectralIndex::sample(const double* frequencies, const size_t n, double* scale) const
+{
+    if (n == 0) {
+        return;
+    }
+    ASKAPCHECK(*std::min_element(frequencies, frequencies + n) > 0.0,
+            "User frequency is zero or negative");
+    const double refFreq = itsReferenceFreq.get("Hz").getValue();
+    const double index = itsSpectralIndex;
+    for (size_t i = 0; i < n; ++i) {
+        scale[i] = std::exp(index * std::log(frequencies[i] / refFreq));
+    }
+}
+
 const casacore::MFrequency& SpectralIndex::getRefFreq(void) const
 {
     return itsReferenceFreq;
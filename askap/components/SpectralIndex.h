@@ -71,6 +71,21 @@ class SpectralIndex : public SpectralModel {
         ///                     negative
         virtual double sample(const casacore::MFrequency& centerFrequency) const;
 
+        /// Returns the scaling factor for a set of frequencies, which are
+        /// validated once and then evaluated as exp(index * log(ratio)) in a
+        /// loop the compiler can vectorise.
+        ///
+        /// @param[in] frequencies  the frequencies, in Hz, which must already be
+        ///                         in the reference frame of the reference
+        ///                         frequency.
+        /// @param[in] n            the number of frequencies.
+        /// @param[out] scale       the scaling factor for each of the n
+        ///                         frequencies.
+        ///
+        /// @throws AskapError  if any frequency is zero or negative
+        virtual void sample(const double* frequencies, const size_t n,
+                            double* scale) const;
+
         /// Returns the reference frequency
         virtual const casacore::MFrequency& getRefFreq(void) const;
 
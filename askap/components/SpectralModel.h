@@ -27,7 +27,8 @@
 #ifndef ASKAP_COMPONENTS_SPECTRALMODEL_H
 #define ASKAP_COMPONENTS_SPECTRALMODEL_H
 
-// ASKAPsoft includes
+// System includes
+#include <cstddef>
 
 // Local package includes
 #include "ComponentType.h"
@@ -44,6 +45,20 @@ class SpectralModel {
 
         /// The type of the component
         virtual ComponentType::SpectralShape type(void) const = 0;
+
+        /// Calculate the scaling factor, which indicates what proportion of
+        /// the flux is at each frequency, for a set of frequencies. This
+        /// allows a whole spectrum to be sampled with one virtual call.
+        ///
+        /// @param[in] frequencies  the frequencies, in Hz, which must already be
+        ///                         in the reference frame of the model.
+        /// @param[in] n            the number of frequencies.
+        /// @param[out] scale       the scaling factor for each of the n
+        ///                         frequencies.
+        ///
+        /// @throws AskapError  if any frequency is zero or negative
+        virtual void sample(const double* frequencies, const size_t n,
+                            double* scale) const = 0;
 };
 
 }
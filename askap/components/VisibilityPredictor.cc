@@ -0,0 +1,296 @@
+/// @file VisibilityPredictor.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// Include own header file first
+#include "VisibilityPredictor.h"
+
+// Include package level header file
+#include "askap_components.h"
+
+// System includes
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <thread>
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Quanta/MVDirection.h"
+#include "casacore/measures/Measures/MDirection.h"
+#include "casacore/measures/Measures/MCDirection.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "components/ComponentModels/ComponentList.h"
+#include "components/ComponentModels/ComponentShape.h"
+#include "components/ComponentModels/ComponentType.h"
+#include "components/ComponentModels/GaussianShape.h"
+#include "components/ComponentModels/SkyComponent.h"
+
+// Local package includes
+#include "Simd.h"
+
+using namespace askap;
+using namespace askap::components;
+using namespace casacore;
+
+namespace {
+
+/// The speed of light, in m/s
+const double SPEED_OF_LIGHT = 299792458.0;
+
+/// The number of channels between exact evaluations of the phase and taper
+const size_t RESEED_CHANNELS = 64;
+
+/// The per component state of one row, held as arrays over the components
+struct RowState {
+    explicit RowState(const size_t n)
+        : tau(n), q(n), zRe(n), zIm(n), rotRe(n), rotIm(n),
+          amp(n), ampRatio(n), ampStep(n), wRe(n), wIm(n) {}
+
+    // The phase is -tau * nu and the taper exp(-q * nu^2)
+    std::vector<double> tau;
+    std::vector<double> q;
+
+    // exp(-i.tau.nu) for the current channel, and the factor to the next
+    std::vector<double> zRe;
+    std::vector<double> zIm;
+    std::vector<double> rotRe;
+    std::vector<double> rotIm;
+
+    // The taper for the current channel, its ratio to the taper of the next
+    // channel, and the (constant) ratio of successive ratios
+    std::vector<double> amp;
+    std::vector<double> ampRatio;
+    std::vector<double> ampStep;
+
+    // The contribution of each component to the current channel, per Jy
+    std::vector<double> wRe;
+    std::vector<double> wIm;
+};
+
+/// @return the index of every component of a list
+std::vector<uInt> allComponents(const ComponentList& list)
+{
+    std::vector<uInt> indices(list.nelements());
+    for (uInt i = 0; i < list.nelements(); ++i) {
+        indices[i] = i;
+    }
+    return indices;
+}
+
+/// Set the phase and taper of every component exactly, for a channel of
+/// frequency nu. With a channel width (for the recurrence) also set the
+/// factors which advance them to the next channel.
+void seed(RowState& state, const double nu, const double width)
+{
+    for (size_t k = 0; k < state.tau.size(); ++k) {
+        const double phase = -state.tau[k] * nu;
+        state.zRe[k] = cos(phase);
+        state.zIm[k] = sin(phase);
+        state.amp[k] = exp(-state.q[k] * nu * nu);
+        if (width != 0.0) {
+            state.rotRe[k] = cos(state.tau[k] * width);
+            state.rotIm[k] = -sin(state.tau[k] * width);
+            state.ampRatio[k] = exp(-state.q[k] * width * (2.0 * nu + width));
+            state.ampStep[k] = exp(-2.0 * state.q[k] * width * width);
+        }
+    }
+}
+
+}
+
+VisibilityPredictor::VisibilityPredictor(const casacore::ComponentList& list,
+        const casacore::MDirection& phaseCentre,
+        const std::vector<const SpectralModel*>* models)
+    : itsL(list.nelements()), itsM(list.nelements()), itsNMinusOne(list.nelements()),
+      itsA(list.nelements(), 0.0), itsB(list.nelements(), 0.0), itsC(list.nelements(), 0.0),
+      itsFluxTable(models ? ComponentFluxTable(list, allComponents(list), *models)
+                   : ComponentFluxTable(list))
+{
+    const MDirection::Ref centreRef(MDirection::castType(phaseCentre.getRef().getType()));
+    const double ra0 = phaseCentre.getValue().getLong();
+    const double dec0 = phaseCentre.getValue().getLat();
+    const double kappa = M_PI * M_PI / (4.0 * M_LN2);
+    for (uInt i = 0; i < list.nelements(); ++i) {
+        const ComponentShape& shape = list.component(i).shape();
+        MDirection dir = shape.refDirection();
+        if (dir.getRef().getType() != phaseCentre.getRef().getType()) {
+            dir = MDirection::Convert(dir, centreRef)();
+        }
+        const double ra = dir.getValue().getLong();
+        const double dec = dir.getValue().getLat();
+        itsL[i] = cos(dec) * sin(ra - ra0);
+        itsM[i] = sin(dec) * cos(dec0) - cos(dec) * sin(dec0) * cos(ra - ra0);
+        const double r2 = itsL[i] * itsL[i] + itsM[i] * itsM[i];
+        itsNMinusOne[i] = -r2 / (1.0 + sqrt(std::max(0.0, 1.0 - r2)));
+
+        switch (shape.type()) {
+            case ComponentType::POINT:
+                break;
+
+            case ComponentType::GAUSSIAN: {
+                // The position angle is of the major axis, from north (+v)
+                // through east (+u)
+                const GaussianShape& gauss = dynamic_cast<const GaussianShape&>(shape);
+                const double major = gauss.majorAxisInRad();
+                const double minor = gauss.minorAxisInRad();
+                const double spa = sin(gauss.positionAngleInRad());
+                const double cpa = cos(gauss.positionAngleInRad());
+                itsA[i] = kappa * (major * major * spa * spa + minor * minor * cpa * cpa);
+                itsB[i] = kappa * (major * major - minor * minor) * spa * cpa;
+                itsC[i] = kappa * (major * major * cpa * cpa + minor * minor * spa * spa);
+                break;
+            }
+
+            default:
+                ASKAPTHROW(AskapError, "Only point and gaussian components can be predicted");
+                break;
+        }
+    }
+}
+
+void VisibilityPredictor::predict(const double* uvw, const size_t nRows,
+                                  const std::vector<double>& frequencies,
+                                  const casacore::Vector<casacore::Stokes::StokesTypes>& stokes,
+                                  std::complex<double>* vis,
+                                  const unsigned int nThreads) const
+{
+    const uInt nPols = stokes.nelements();
+    for (uInt p = 0; p < nPols; ++p) {
+        ASKAPCHECK(stokes(p) == Stokes::I || stokes(p) == Stokes::Q ||
+                   stokes(p) == Stokes::U || stokes(p) == Stokes::V,
+                   "Can only predict I, Q, U or V visibilities");
+    }
+    const size_t nChannels = frequencies.size();
+    std::vector<double> logFreqs(nChannels);
+    for (size_t j = 0; j < nChannels; ++j) {
+        ASKAPCHECK(frequencies[j] > 0.0, "Frequencies must be positive");
+        logFreqs[j] = log(frequencies[j]);
+    }
+    const size_t nComponents = nelements();
+    if (nRows == 0 || nChannels == 0 || nComponents == 0) {
+        return;
+    }
+
+    // The recurrence needs evenly spaced channels
+    const double width = (nChannels > 1) ? frequencies[1] - frequencies[0] : 0.0;
+    bool uniform = nChannels > 1;
+    for (size_t j = 2; j < nChannels && uniform; ++j) {
+        const double expected = frequencies[0] + j * width;
+        uniform = std::abs(frequencies[j] - expected) <= 1.e-10 * frequencies[j];
+    }
+
+    // The spectral scale, indexed (chan * nComponents + k), and the flux at
+    // the reference frequency, indexed (pol * nComponents + k)
+    std::vector<double> scale(nChannels * nComponents);
+    std::vector<double> polFlux(nPols * nComponents);
+    {
+        std::vector<double> componentScale(nChannels);
+        for (uInt k = 0; k < nComponents; ++k) {
+            itsFluxTable.spectralScale(k, logFreqs, &componentScale[0]);
+            for (size_t j = 0; j < nChannels; ++j) {
+                scale[j * nComponents + k] = componentScale[j];
+            }
+            for (uInt p = 0; p < nPols; ++p) {
+                polFlux[p * nComponents + k] = itsFluxTable.flux(k, stokes(p));
+            }
+        }
+    }
+
+    // Each thread predicts a contiguous range of rows
+    auto predictRows = [&](const size_t rowStart, const size_t rowEnd) {
+        RowState state(nComponents);
+        for (size_t row = rowStart; row < rowEnd; ++row) {
+            const double u = uvw[3 * row];
+            const double v = uvw[3 * row + 1];
+            const double w = uvw[3 * row + 2];
+            const double phaseScale = 2.0 * M_PI / SPEED_OF_LIGHT;
+            const double taperScale = 1.0 / (SPEED_OF_LIGHT * SPEED_OF_LIGHT);
+            for (size_t k = 0; k < nComponents; ++k) {
+                state.tau[k] = phaseScale * (u * itsL[k] + v * itsM[k] + w * itsNMinusOne[k]);
+                state.q[k] = taperScale * ((itsA[k] * u + 2.0 * itsB[k] * v) * u
+                                           + itsC[k] * v * v);
+            }
+
+            std::complex<double>* rowVis = vis + row * nChannels * nPols;
+            for (size_t j = 0; j < nChannels; ++j) {
+                if (!uniform || j % RESEED_CHANNELS == 0) {
+                    seed(state, frequencies[j], uniform ? width : 0.0);
+                }
+
+                const double* chanScale = &scale[j * nComponents];
+                double* wRe = &state.wRe[0];
+                double* wIm = &state.wIm[0];
+                double* zRe = &state.zRe[0];
+                double* zIm = &state.zIm[0];
+                double* amp = &state.amp[0];
+                const double* rotRe = &state.rotRe[0];
+                const double* rotIm = &state.rotIm[0];
+                double* ampRatio = &state.ampRatio[0];
+                const double* ampStep = &state.ampStep[0];
+                ASKAP_SIMD
+                for (size_t k = 0; k < nComponents; ++k) {
+                    const double weight = chanScale[k] * amp[k];
+                    wRe[k] = weight * zRe[k];
+                    wIm[k] = weight * zIm[k];
+
+                    // Advance to the next channel. Without the recurrence
+                    // these are reset by seed()
+                    const double re = zRe[k] * rotRe[k] - zIm[k] * rotIm[k];
+                    zIm[k] = zRe[k] * rotIm[k] + zIm[k] * rotRe[k];
+                    zRe[k] = re;
+                    amp[k] *= ampRatio[k];
+                    ampRatio[k] *= ampStep[k];
+                }
+
+                for (uInt p = 0; p < nPols; ++p) {
+                    const double* flux = &polFlux[p * nComponents];
+                    double sumRe = 0.0;
+                    double sumIm = 0.0;
+                    for (size_t k = 0; k < nComponents; ++k) {
+                        sumRe += flux[k] * wRe[k];
+                        sumIm += flux[k] * wIm[k];
+                    }
+                    rowVis[j * nPols + p] += std::complex<double>(sumRe, sumIm);
+                }
+            }
+        }
+    };
+
+    const size_t nWorkers = std::min(nRows, static_cast<size_t>((nThreads > 0) ? nThreads
+                                     : std::max(1u, std::thread::hardware_concurrency())));
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < nWorkers; ++t) {
+        threads.push_back(std::thread(predictRows, t * nRows / nWorkers,
+                                      (t + 1) * nRows / nWorkers));
+    }
+    predictRows(0, nRows / nWorkers);
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+}
@@ -0,0 +1,135 @@
+/// @file VisibilityPredictor.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_VISIBILITYPREDICTOR_H
+#define ASKAP_COMPONENTS_VISIBILITYPREDICTOR_H
+
+// System includes
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// ASKAPsoft includes
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/measures/Measures/MDirection.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "casarest/components/ComponentModels/ComponentList.h"
+
+// Local package includes
+#include "ComponentFluxTable.h"
+#include "SpectralModel.h"
+
+namespace askap {
+namespace components {
+
+/// @brief Predicts model visibilities of a component list directly, without
+/// making a model image.
+///
+/// Each component contributes
+///     S(nu) * G(u, v) * exp(-2 pi i (u.l + v.m + w.(n - 1)))
+/// to the visibility, where (l, m, n) are its direction cosines relative to
+/// the phase centre, (u, v, w) is the baseline in wavelengths, S is the flux
+/// from the same ComponentFluxTable (and so the same spectral models) as
+/// AskapComponentImager::project(), and G is the Fourier transform of the
+/// shape: one for a point, and
+///     exp(-pi^2 / (4 ln 2) * (major^2 * uMajor^2 + minor^2 * uMinor^2))
+/// for a gaussian, where major and minor are the FWHMs in radians and
+/// uMajor, uMinor are the components of (u, v) along each axis.
+///
+/// Each row is evaluated for all channels at once. When the channels are
+/// evenly spaced the phase and the gaussian taper of each component are
+/// advanced from one channel to the next by complex (and real) multiplication
+/// rather than by calls to sin, cos and exp, with an exact evaluation every
+/// 64 channels to bound the rounding error. The components are held as
+/// arrays, so the loops over components vectorise.
+///
+/// Thread Safety:
+/// The predict function does not modify the instance, so one instance may
+/// be shared between threads.
+class VisibilityPredictor {
+    public:
+        /// Constructor
+        /// Prepares the components of a list for prediction.
+        ///
+        /// @param[in] list         the component list.
+        /// @param[in] phaseCentre  the phase centre of the visibilities.
+        /// @param[in] models       optional spectral models which replace
+        ///                         those of the list, as for
+        ///                         ProjectionOptions::spectralModels.
+        /// @throw AskapError   if a component is not a point or a gaussian,
+        ///                     or has an unsupported spectral model.
+        VisibilityPredictor(const casacore::ComponentList& list,
+                            const casacore::MDirection& phaseCentre,
+                            const std::vector<const SpectralModel*>* models = 0);
+
+        /// @return the number of components
+        casacore::uInt nelements(void) const { return itsL.size(); }
+
+        /// Predict the visibilities of a set of rows and add them to vis.
+        ///
+        /// @param[in] uvw          the (u, v, w) of row r, in metres, in
+        ///                         elements 3r to 3r + 2. These are in the
+        ///                         frame of the phase centre.
+        /// @param[in] nRows        the number of rows.
+        /// @param[in] frequencies  the frequency of each channel, in Hz.
+        /// @param[in] stokes       the polarisations to predict, each of
+        ///                         which must be one of I, Q, U or V.
+        /// @param[inout] vis       the visibilities, to which the prediction
+        ///                         is added, indexed
+        ///                         ((row * nChannels + chan) * nPols + pol).
+        /// @param[in] nThreads     the number of threads, which share the
+        ///                         rows. Zero uses one thread per core. The
+        ///                         result does not depend on the number.
+        /// @throw AskapError   if a polarisation is not I, Q, U or V, or a
+        ///                     frequency is not positive.
+        void predict(const double* uvw, const size_t nRows,
+                     const std::vector<double>& frequencies,
+                     const casacore::Vector<casacore::Stokes::StokesTypes>& stokes,
+                     std::complex<double>* vis,
+                     const unsigned int nThreads = 1) const;
+
+    private:
+        // Direction cosines relative to the phase centre, with n - 1 held
+        // as such for precision near the centre
+        std::vector<double> itsL;
+        std::vector<double> itsM;
+        std::vector<double> itsNMinusOne;
+
+        // The gaussian taper exp(-(a.u^2 + 2b.u.v + c.v^2)) for (u, v) in
+        // wavelengths, or zero for a point
+        std::vector<double> itsA;
+        std::vector<double> itsB;
+        std::vector<double> itsC;
+
+        // The flux and spectrum of each component
+        ComponentFluxTable itsFluxTable;
+};
+
+}
+}
+
+#endif
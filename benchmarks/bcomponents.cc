@@ -0,0 +1,404 @@
+/// @file bcomponents.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+///
+/// @brief Benchmarks of the component imager.
+///
+/// Each benchmark is run repeatedly until it has taken at least the minimum
+/// time (one second by default), and the mean time per iteration reported.
+/// Usage: bcomponents [-t minSeconds] [filter]. Only the benchmarks whose
+/// name contains the filter string are run.
+
+// System includes
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ASKAPsoft includes
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/OS/Directory.h>
+#include <casacore/casa/Quanta/Quantum.h>
+#include <casacore/coordinates/Coordinates/CoordinateSystem.h>
+#include <casacore/coordinates/Coordinates/DirectionCoordinate.h>
+#include <casacore/coordinates/Coordinates/SpectralCoordinate.h>
+#include <casacore/coordinates/Coordinates/StokesCoordinate.h>
+#include <casacore/images/Images/ImageInterface.h>
+#include <casacore/images/Images/PagedImage.h>
+#include <casacore/images/Images/TempImage.h>
+#include <casacore/lattices/Lattices/TiledShape.h>
+#include <casacore/measures/Measures/MDirection.h>
+#include <casacore/measures/Measures/MFrequency.h>
+#include <casacore/measures/Measures/Stokes.h>
+#include <casacore/scimath/Functionals/Gaussian2D.h>
+#include <components/ComponentModels/ComponentList.h>
+#include <components/ComponentModels/ConstantSpectrum.h>
+#include <components/ComponentModels/Flux.h>
+#include <components/ComponentModels/GaussianShape.h>
+#include <components/ComponentModels/PointShape.h>
+#include <components/ComponentModels/SkyComponent.h>
+#include <components/ComponentModels/SpectralIndex.h>
+
+// Classes to benchmark
+#include <askap/components/AskapComponentImager.h>
+#include <askap/components/SpectralIndex.h>
+
+using namespace casacore;
+using askap::components::AskapComponentImager;
+using askap::components::ProjectionOptions;
+
+namespace {
+
+/// Times repeated iterations of a benchmark
+class BenchmarkState {
+    public:
+        explicit BenchmarkState(const double minSeconds)
+            : itsMinSeconds(minSeconds), itsIterations(0), itsItems(0), itsSeconds(0.0) {}
+
+        /// @return true while the benchmark should do another iteration. The
+        /// timing starts with the first call, so excludes any setup.
+        bool keepRunning()
+        {
+            if (itsIterations == 0) {
+                itsStart = std::chrono::steady_clock::now();
+            } else {
+                const std::chrono::duration<double> time =
+                    std::chrono::steady_clock::now() - itsStart;
+                if (time.count() >= itsMinSeconds) {
+                    itsSeconds = time.count();
+                    return false;
+                }
+            }
+            ++itsIterations;
+            return true;
+        }
+
+        /// Set the number of items (e.g. components or pixels) processed
+        /// by each iteration, which are reported as a rate
+        void setItemsPerIteration(const size_t items) { itsItems = items; }
+
+        /// @return the time taken by all of the iterations, in seconds
+        double seconds() const { return itsSeconds; }
+
+        size_t iterations() const { return itsIterations; }
+
+        size_t itemsPerIteration() const { return itsItems; }
+
+    private:
+        double itsMinSeconds;
+        size_t itsIterations;
+        size_t itsItems;
+        double itsSeconds;
+        std::chrono::steady_clock::time_point itsStart;
+};
+
+struct Benchmark {
+    std::string name;
+    std::function<void(BenchmarkState&)> run;
+};
+
+/// The image backing
+enum Backing {
+    TEMP_IMAGE,
+    PAGED_IMAGE
+};
+
+/// The parameters of a project() benchmark
+struct ProjectParams {
+    ProjectParams() : nComponents(1000), gaussianFraction(0.5), majorAxis(20.0),
+        minorAxis(10.0), imageSize(512), nChannels(4), nPols(1),
+        backing(TEMP_IMAGE) {}
+
+    std::string name() const
+    {
+        std::ostringstream os;
+        os << "project/components:" << nComponents
+           << "/gaussians:" << gaussianFraction
+           << "/axes:" << majorAxis << "x" << minorAxis
+           << "/size:" << imageSize
+           << "/channels:" << nChannels
+           << "/pols:" << nPols
+           << "/" << (backing == TEMP_IMAGE ? "TempImage" : "PagedImage");
+        return os.str();
+    }
+
+    uInt nComponents;
+
+    /// The fraction of the components which are gaussians, the rest are points
+    double gaussianFraction;
+
+    /// The gaussian FWHM, in arcsec. The pixels are 5 arcsec, so a minor axis
+    /// below 0.005 arcsec takes the one dimensional branch.
+    double majorAxis;
+    double minorAxis;
+
+    uInt imageSize;
+    uInt nChannels;
+    uInt nPols;
+    Backing backing;
+};
+
+CoordinateSystem createCoordinateSystem(const uInt size, const uInt nPols)
+{
+    CoordinateSystem coordsys;
+    Matrix<Double> xform(2, 2);
+    xform = 0.0;
+    xform.diagonal() = 1.0;
+    const DirectionCoordinate radec(MDirection::J2000, Projection(Projection::SIN),
+                                    Quantum<Double>(187.5, "deg"), Quantum<Double>(-45.0, "deg"),
+                                    Quantum<Double>(-5.0, "arcsec"), Quantum<Double>(5.0, "arcsec"),
+                                    xform, size / 2, size / 2);
+    coordsys.addCoordinate(radec);
+
+    const Stokes::StokesTypes pols[] = {Stokes::I, Stokes::Q, Stokes::U, Stokes::V};
+    Vector<Int> stokes(nPols);
+    for (uInt p = 0; p < nPols; ++p) {
+        stokes(p) = pols[p];
+    }
+    coordsys.addCoordinate(StokesCoordinate(stokes));
+
+    coordsys.addCoordinate(SpectralCoordinate(MFrequency::TOPO, Quantum<Double>(1400.0, "MHz"),
+                                              Quantum<Double>(1.0, "MHz"), 0.0));
+    return coordsys;
+}
+
+/// Components spread uniformly (on a fixed pseudo-random sequence) over
+/// the image, alternating between flat and power law spectra
+ComponentList createList(const ProjectParams& params)
+{
+    const casacore::SpectralIndex spectralIndex(MFrequency(Quantum<Double>(1400, "MHz")), -0.7);
+    const casacore::ConstantSpectrum constant;
+    const double halfWidth = 0.5 * params.imageSize * 5.0 / 3600.0;
+    const double cosDec = cos(45.0 * M_PI / 180.0);
+    unsigned int seed = 12345;
+    auto uniform = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return ((seed >> 8) & 0xffff) / 65536.0;
+    };
+
+    ComponentList list;
+    for (uInt i = 0; i < params.nComponents; ++i) {
+        const MDirection dir(Quantum<Double>(187.5 + (2.0 * uniform() - 1.0) * halfWidth / cosDec,
+                                             "deg"),
+                             Quantum<Double>(-45.0 + (2.0 * uniform() - 1.0) * halfWidth, "deg"),
+                             MDirection::J2000);
+        const Flux<Double> flux(1.0 + uniform(), 0.1, -0.05, 0.0);
+        const casacore::SpectralModel& spectrum = (i % 2)
+            ? static_cast<const casacore::SpectralModel&>(spectralIndex)
+            : static_cast<const casacore::SpectralModel&>(constant);
+        if (uniform() < params.gaussianFraction) {
+            const GaussianShape shape(dir, Quantum<Double>(params.majorAxis, "arcsec"),
+                                      Quantum<Double>(params.minorAxis, "arcsec"),
+                                      Quantum<Double>(360.0 * uniform(), "deg"));
+            list.add(SkyComponent(flux, shape, spectrum));
+        } else {
+            list.add(SkyComponent(flux, PointShape(dir), spectrum));
+        }
+    }
+    return list;
+}
+
+void benchmarkProject(const ProjectParams& params, BenchmarkState& state)
+{
+    const ComponentList list = createList(params);
+    const IPosition shape(4, params.imageSize, params.imageSize, params.nPols, params.nChannels);
+    const CoordinateSystem coords = createCoordinateSystem(params.imageSize, params.nPols);
+    const std::string pagedName = "bcomponents_tmp.img";
+    {
+        TempImage<Float> temp(TiledShape(shape), coords);
+        PagedImage<Float>* paged = 0;
+        ImageInterface<Float>* image = &temp;
+        if (params.backing == PAGED_IMAGE) {
+            paged = new PagedImage<Float>(TiledShape(shape), coords, pagedName);
+            image = paged;
+        }
+        image->set(0.0);
+
+        state.setItemsPerIteration(params.nComponents);
+        while (state.keepRunning()) {
+            AskapComponentImager::project(*image, list);
+        }
+        delete paged;
+    }
+    if (params.backing == PAGED_IMAGE) {
+        Directory(pagedName).removeRecursive();
+    }
+}
+
+void benchmarkSpectralIndex(const bool vectorised, BenchmarkState& state)
+{
+    const askap::components::SpectralIndex model(MFrequency(Quantum<Double>(1400, "MHz")), -0.7);
+    const size_t nFreqs = 16384;
+    std::vector<double> freqs(nFreqs);
+    std::vector<MFrequency> mfreqs;
+    for (size_t i = 0; i < nFreqs; ++i) {
+        freqs[i] = 7.0e8 + i * 1.0e5;
+        mfreqs.push_back(MFrequency(Quantum<Double>(freqs[i], "Hz")));
+    }
+    std::vector<double> scale(nFreqs);
+    double sum = 0.0;
+    state.setItemsPerIteration(nFreqs);
+    while (state.keepRunning()) {
+        if (vectorised) {
+            model.sample(&freqs[0], nFreqs, &scale[0]);
+        } else {
+            for (size_t i = 0; i < nFreqs; ++i) {
+                scale[i] = model.sample(mfreqs[i]);
+            }
+        }
+        sum += scale[nFreqs - 1];
+    }
+    if (sum < 0.0) {
+        std::cout << sum << std::endl;
+    }
+}
+
+void benchmarkEvaluateGaussian(const double axialRatio,
+                               const ProjectionOptions::GaussianKernel kernel,
+                               BenchmarkState& state)
+{
+    Gaussian2D<Double> gauss(1.0, 0.3, -0.2, 4.0, axialRatio, 0.6);
+    gauss.setFlux(1.0);
+    const int halfWidth = 8;
+    double sum = 0.0;
+    state.setItemsPerIteration((2 * halfWidth + 1) * (2 * halfWidth + 1));
+    while (state.keepRunning()) {
+        for (int y = -halfWidth; y <= halfWidth; ++y) {
+            for (int x = -halfWidth; x <= halfWidth; ++x) {
+                sum += AskapComponentImager::evaluateGaussian(gauss, x, y, kernel);
+            }
+        }
+    }
+    if (sum < 0.0) {
+        std::cout << sum << std::endl;
+    }
+}
+
+std::vector<Benchmark> registerBenchmarks()
+{
+    std::vector<Benchmark> benchmarks;
+
+    // Vary one parameter at a time from the defaults
+    std::vector<ProjectParams> cases(1);
+    const uInt counts[] = {100, 10000};
+    for (size_t i = 0; i < 2; ++i) {
+        cases.push_back(ProjectParams());
+        cases.back().nComponents = counts[i];
+    }
+    const double fractions[] = {0.0, 1.0};
+    for (size_t i = 0; i < 2; ++i) {
+        cases.push_back(ProjectParams());
+        cases.back().gaussianFraction = fractions[i];
+    }
+    const double axes[][2] = {{8.0, 6.0}, {120.0, 60.0}, {40.0, 0.001}};
+    for (size_t i = 0; i < 3; ++i) {
+        cases.push_back(ProjectParams());
+        cases.back().gaussianFraction = 1.0;
+        cases.back().majorAxis = axes[i][0];
+        cases.back().minorAxis = axes[i][1];
+    }
+    const uInt sizes[] = {128, 2048};
+    for (size_t i = 0; i < 2; ++i) {
+        cases.push_back(ProjectParams());
+        cases.back().imageSize = sizes[i];
+    }
+    const uInt channels[] = {1, 32};
+    for (size_t i = 0; i < 2; ++i) {
+        cases.push_back(ProjectParams());
+        cases.back().nChannels = channels[i];
+    }
+    cases.push_back(ProjectParams());
+    cases.back().nPols = 4;
+    cases.push_back(ProjectParams());
+    cases.back().backing = PAGED_IMAGE;
+
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const ProjectParams params = cases[i];
+        benchmarks.push_back(Benchmark{params.name(),
+            [params](BenchmarkState& state) { benchmarkProject(params, state); }});
+    }
+
+    benchmarks.push_back(Benchmark{"SpectralIndex::sample/MFrequency",
+        [](BenchmarkState& state) { benchmarkSpectralIndex(false, state); }});
+    benchmarks.push_back(Benchmark{"SpectralIndex::sample/array",
+        [](BenchmarkState& state) { benchmarkSpectralIndex(true, state); }});
+
+    benchmarks.push_back(Benchmark{"evaluateGaussian/simpson",
+        [](BenchmarkState& state) {
+            benchmarkEvaluateGaussian(0.5, ProjectionOptions::SIMPSON, state); }});
+    benchmarks.push_back(Benchmark{"evaluateGaussian/simpson_single",
+        [](BenchmarkState& state) {
+            benchmarkEvaluateGaussian(0.5, ProjectionOptions::SIMPSON_SINGLE, state); }});
+    benchmarks.push_back(Benchmark{"evaluateGaussian/analytic",
+        [](BenchmarkState& state) {
+            benchmarkEvaluateGaussian(0.5, ProjectionOptions::ANALYTIC, state); }});
+    benchmarks.push_back(Benchmark{"evaluateGaussian/1d",
+        [](BenchmarkState& state) {
+            benchmarkEvaluateGaussian(1.e-5, ProjectionOptions::SIMPSON, state); }});
+    return benchmarks;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    double minSeconds = 1.0;
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    const std::vector<Benchmark> benchmarks = registerBenchmarks();
+    std::cout << std::left << std::setw(96) << "Benchmark" << std::right
+              << std::setw(14) << "Time (ms)" << std::setw(12) << "Iterations"
+              << std::setw(16) << "Items/s" << std::endl;
+    for (size_t b = 0; b < benchmarks.size(); ++b) {
+        if (!filter.empty() && benchmarks[b].name.find(filter) == std::string::npos) {
+            continue;
+        }
+        BenchmarkState state(minSeconds);
+        benchmarks[b].run(state);
+        const double seconds = state.seconds() / state.iterations();
+        std::cout << std::left << std::setw(96) << benchmarks[b].name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(3) << seconds * 1.e3
+                  << std::setw(12) << state.iterations()
+                  << std::setw(16) << std::scientific << std::setprecision(3)
+                  << state.itemsPerIteration() / seconds << std::endl;
+    }
+    return 0;
+}
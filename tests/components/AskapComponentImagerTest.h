@@ -26,6 +26,8 @@
 
 // System includes
 #include <limits>
+#include <cstdio>
+#include <string>
 
 // CPPUnit includes
 #include <cppunit/extensions/HelperMacros.h>
@@ -36,6 +38,8 @@
 #include <askap/askap/Log4cxxLogSink.h>
 #include <casacore/casa/aipstype.h>
 #include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
 #include <casacore/casa/Quanta.h>
 #include <casacore/casa/Quanta/Quantum.h>
 #include <casacore/images/Images/TempImage.h>
@@ -49,13 +53,26 @@
 #include <components/ComponentModels/SpectralIndex.h>
 #include <components/ComponentModels/PointShape.h>
 #include <components/ComponentModels/GaussianShape.h>
+#include <components/ComponentModels/DiskShape.h>
 #include <casacore/coordinates/Coordinates/CoordinateSystem.h>
 #include <casacore/coordinates/Coordinates/DirectionCoordinate.h>
 #include <casacore/coordinates/Coordinates/SpectralCoordinate.h>
 #include <casacore/coordinates/Coordinates/StokesCoordinate.h>
+#include <casacore/scimath/Functionals/Gaussian2D.h>
+#include <casacore/scimath/Mathematics/GaussianBeam.h>
+
+// Test fixtures
+#include "ProjectorTestFixture.h"
 
 // Classes to test
 #include <askap/components/AskapComponentImager.h>
+#include <askap/components/ComponentCatalogue.h>
+#include <askap/components/PixelPositionCache.h>
+#include <askap/components/ComponentIndex.h>
+#include <askap/components/FootprintCache.h>
+#include <askap/components/ProjectionStats.h>
+#include <askap/components/CurvedSpectrum.h>
+#include <askap/components/SparseModel.h>
 
 // Using
 using namespace askap;
@@ -66,11 +83,32 @@ using namespace std;
 namespace askap {
 namespace components {
 
-class AskapComponentImagerTest : public CppUnit::TestFixture {
+class AskapComponentImagerTest : public CppUnit::TestFixture, private ProjectorTestFixture {
         CPPUNIT_TEST_SUITE(AskapComponentImagerTest);
         CPPUNIT_TEST(testFourPols);
         CPPUNIT_TEST(testGaussian);
+        CPPUNIT_TEST(testGaussianSpectralIndex);
+        CPPUNIT_TEST(testGaussianAnalyticKernel);
+        CPPUNIT_TEST(testGaussianCutoff);
+        CPPUNIT_TEST(testLineGaussian);
+        CPPUNIT_TEST(testDisk);
         CPPUNIT_TEST(testTaylorTerms);
+        CPPUNIT_TEST(testTaylorTermsSinglePass);
+        CPPUNIT_TEST(testCurvedSpectrum);
+        CPPUNIT_TEST(testPositionCache);
+        CPPUNIT_TEST(testComponentIndex);
+        CPPUNIT_TEST(testComponentIndexPositionCache);
+        CPPUNIT_TEST(testStats);
+        CPPUNIT_TEST(testMultithreaded);
+        CPPUNIT_TEST(testChannelBlocks);
+        CPPUNIT_TEST(testSparseModel);
+        CPPUNIT_TEST(testRestoringBeam);
+        CPPUNIT_TEST(testFootprintCache);
+        CPPUNIT_TEST(testFootprintCacheRestored);
+        CPPUNIT_TEST(testCompensatedSummation);
+        CPPUNIT_TEST(testWriteQueue);
+        CPPUNIT_TEST(testCatalogue);
+        CPPUNIT_TEST(testSkewedFootprints);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -166,6 +204,193 @@ class AskapComponentImagerTest : public CppUnit::TestFixture {
             //pimage.copyData(image);
         }
 
+        void testGaussianSpectralIndex() {
+            ComponentList list;
+
+            // Centre of the image
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+
+            // Create a component at the image centre with a spectral index
+            const Flux<casacore::Double> flux(1.0);
+            const SpectralIndex spectrum(MFrequency(Quantity(1400, "MHz")), -0.7);
+            const GaussianShape shape(dir,
+                    casacore::Quantity(12.0, "arcsec"),
+                    casacore::Quantity(6.0, "arcsec"),
+                    casacore::Quantity(30, "deg"));
+            list.add(SkyComponent(flux, shape, spectrum));
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            const uInt nChan = 3;
+            TempImage<Float> image = createImage<Float>(dir, 256, 256, iquv, nChan);
+            AskapComponentImager::project(image, list);
+
+            // Each channel should have the same footprint, scaled by the
+            // spectral index, and should conserve the total flux
+            const IPosition centre0(4, 128, 128, 0, 0);
+            const IPosition offset0(4, 127, 129, 0, 0);
+            for (uInt chan = 0; chan < nChan; ++chan) {
+                const Double freq = 1400.0e6 + chan * 300.0e6;
+                const Double scale = spectrum.sample(MFrequency(Quantity(freq, "Hz")));
+
+                IPosition centre(centre0);
+                IPosition offset(offset0);
+                centre(3) = chan;
+                offset(3) = chan;
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(image.getAt(centre0) * scale,
+                        image.getAt(centre), 1e-6);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(image.getAt(offset0) * scale,
+                        image.getAt(offset), 1e-6);
+
+                const Array<Float> plane = image.getSlice(IPosition(4, 0, 0, 0, chan),
+                        IPosition(4, 256, 256, 1, 1));
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(scale, casacore::sum(plane), 1e-3);
+            }
+        }
+
+        void testGaussianAnalyticKernel() {
+            // Compare the analytic kernel with Simpson's rule, both for a
+            // gaussian aligned with the pixel grid and a rotated one
+            for (uInt i = 0; i < 2; ++i) {
+                Gaussian2D<Double> gauss(1.0, 0.3, -0.2, 4.0, 0.5, (i == 0) ? 0.0 : 0.6);
+                gauss.setFlux(1.0);
+                Double total = 0.0;
+                for (int x = -20; x <= 20; ++x) {
+                    for (int y = -20; y <= 20; ++y) {
+                        const double analytic = AskapComponentImager::evaluateGaussian(gauss, x, y,
+                                ProjectionOptions::ANALYTIC);
+                        const double simpson = AskapComponentImager::evaluateGaussian(gauss, x, y,
+                                ProjectionOptions::SIMPSON);
+                        CPPUNIT_ASSERT_DOUBLES_EQUAL(simpson, analytic, 1e-7);
+                        total += analytic;
+                    }
+                }
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, total, 1e-8);
+            }
+
+            // And the projected images
+            ComponentList list = createMixedList();
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Double> simpson = createImage<Double>(dir, 128, 128, iquv);
+            AskapComponentImager::project(simpson, list);
+
+            ProjectionOptions options;
+            options.gaussianKernel = ProjectionOptions::ANALYTIC;
+            TempImage<Double> analytic = createImage<Double>(dir, 128, 128, iquv);
+            AskapComponentImager::project(analytic, list, 0, options);
+            CPPUNIT_ASSERT(allNearAbs(simpson.get(), analytic.get(), 1e-6));
+        }
+
+        void testGaussianCutoff() {
+            ComponentList list;
+
+            // Centre of the image
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+
+            // An elongated gaussian with its major axis along the y axis. The
+            // sigma is ~3.4 pixels for the major axis and ~0.68 for the minor
+            const Flux<casacore::Double> flux(1.0);
+            const ConstantSpectrum spectrum;
+            const GaussianShape shape(dir,
+                    casacore::Quantity(40.0, "arcsec"),
+                    casacore::Quantity(8.0, "arcsec"),
+                    casacore::Quantity(0, "deg"));
+            list.add(SkyComponent(flux, shape, spectrum));
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            TempImage<Double> epsilon = createImage<Double>(dir, 256, 256, iquv);
+            AskapComponentImager::project(epsilon, list);
+
+            // Truncating at 3 sigma only keeps pixels within ~2 pixels of the
+            // centre along the minor axis, but 10 along the major axis
+            ProjectionOptions options;
+            options.cutoffPolicy = ProjectionOptions::N_SIGMA;
+            options.cutoffValue = 3.0;
+            TempImage<Double> nSigma = createImage<Double>(dir, 256, 256, iquv);
+            AskapComponentImager::project(nSigma, list, 0, options);
+            CPPUNIT_ASSERT(epsilon.getAt(IPosition(4, 132, 128, 0, 0)) > 0.0);
+            CPPUNIT_ASSERT_EQUAL(0.0, nSigma.getAt(IPosition(4, 132, 128, 0, 0)));
+            CPPUNIT_ASSERT(nSigma.getAt(IPosition(4, 130, 128, 0, 0)) > 0.0);
+            CPPUNIT_ASSERT(nSigma.getAt(IPosition(4, 128, 138, 0, 0)) > 0.0);
+            CPPUNIT_ASSERT_EQUAL(0.0, nSigma.getAt(IPosition(4, 128, 140, 0, 0)));
+            const Double total = casacore::sum(nSigma.get());
+            CPPUNIT_ASSERT(total > 0.98 && total < 1.0);
+
+            // A very small relative cutoff should match the default
+            options.cutoffPolicy = ProjectionOptions::RELATIVE_TO_PEAK;
+            options.cutoffValue = 1e-12;
+            TempImage<Double> relative = createImage<Double>(dir, 256, 256, iquv);
+            AskapComponentImager::project(relative, list, 0, options);
+            CPPUNIT_ASSERT(allNearAbs(epsilon.get(), relative.get(), 1e-10));
+
+            // Invalid cutoff values
+            options.cutoffValue = 1.5;
+            CPPUNIT_ASSERT_THROW(AskapComponentImager::project(relative, list, 0, options),
+                    askap::AskapError);
+            options.cutoffPolicy = ProjectionOptions::ABSOLUTE_FLUX;
+            options.cutoffValue = 0.0;
+            CPPUNIT_ASSERT_THROW(AskapComponentImager::project(relative, list, 0, options),
+                    askap::AskapError);
+        }
+
+        void testLineGaussian() {
+            // A gaussian with a minor axis far below a pixel is rendered as
+            // a line, which only deposits flux in the pixels it crosses
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            const GaussianShape shape(dir,
+                    casacore::Quantity(40.0, "arcsec"),
+                    casacore::Quantity(0.001, "arcsec"),
+                    casacore::Quantity(30, "deg"));
+            ComponentList list;
+            list.add(SkyComponent(Flux<casacore::Double>(1.0), shape, ConstantSpectrum()));
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            TempImage<Double> image = createImage<Double>(dir, 128, 128, iquv);
+            AskapComponentImager::project(image, list);
+            CPPUNIT_ASSERT(image.getAt(IPosition(4, 64, 64, 0, 0)) > 0.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, sum(image.get()), 1e-6);
+            CPPUNIT_ASSERT(ntrue(image.get() != 0.0) < 2 * 128);
+        }
+
+        void testDisk() {
+            // A 60 x 40 arcsec disk, which is 12 x 8 pixels
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            const DiskShape shape(dir,
+                    casacore::Quantity(60.0, "arcsec"),
+                    casacore::Quantity(40.0, "arcsec"),
+                    casacore::Quantity(30, "deg"));
+            ComponentList list;
+            list.add(SkyComponent(Flux<casacore::Double>(1.0), shape, ConstantSpectrum()));
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            TempImage<Float> image = createImage<Float>(dir, 64, 64, iquv);
+            AskapComponentImager::project(image, list);
+
+            // The centre pixel is entirely within the disk, so has the
+            // surface brightness of the disk, and all of the flux is on the
+            // image. Pixels beyond the semi-major axis are empty.
+            const double brightness = 1.0 / (M_PI * 6.0 * 4.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(brightness, image.getAt(IPosition(4, 32, 32, 0, 0)), 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, sum(image.get()), 1e-5);
+            CPPUNIT_ASSERT_EQUAL(0.0f, image.getAt(IPosition(4, 32, 40, 0, 0)));
+            CPPUNIT_ASSERT_EQUAL(0.0f, image.getAt(IPosition(4, 40, 32, 0, 0)));
+        }
+
         void testTaylorTerms() {
             ComponentList list;
 
@@ -215,61 +440,598 @@ class AskapComponentImagerTest : public CppUnit::TestFixture {
                     askap::AskapError);
         }
 
-    private:
-        casacore::CoordinateSystem createCoordinateSystem(const casacore::uInt nx, const casacore::uInt ny,
-            const Vector<Int>& stokes)
-        {
-            CoordinateSystem coordsys;
+        void testTaylorTermsSinglePass() {
+            ComponentList list = createMixedList();
+            Vector<Int> iquv(2);
+            iquv(0) = Stokes::I; iquv(1) = Stokes::Q;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
 
-            // Direction Coordinate
-            {
-                Matrix<Double> xform(2, 2);
-                xform = 0.0;
-                xform.diagonal() = 1.0;
-                const Quantum<Double> ra(187.5, "deg");
-                const Quantum<Double> dec(-45.0, "deg");
+            // With a footprint which does not depend on the flux, projecting
+            // all terms at once must match projecting each term separately
+            ProjectionOptions options;
+            options.cutoffPolicy = ProjectionOptions::N_SIGMA;
+            options.cutoffValue = 5.0;
+            std::vector<TempImage<Float> > terms;
+            for (uInt t = 0; t < 3; ++t) {
+                terms.push_back(createImage<Float>(dir, 128, 128, iquv, 2));
+            }
+            std::vector<ImageInterface<Float>*> images;
+            for (uInt t = 0; t < 3; ++t) {
+                images.push_back(&terms[t]);
+            }
+            AskapComponentImager::project(images, list, options);
+            for (uInt t = 0; t < 3; ++t) {
+                TempImage<Float> single = createImage<Float>(dir, 128, 128, iquv, 2);
+                AskapComponentImager::project(single, list, t, options);
+                CPPUNIT_ASSERT(allEQ(single.get(), terms[t].get()));
+                CPPUNIT_ASSERT(casacore::sum(abs(single.get())) > 0.0);
+            }
+
+            // Images must share a pixel grid
+            TempImage<Float> other = createImage<Float>(dir, 64, 64, iquv, 2);
+            images[2] = &other;
+            CPPUNIT_ASSERT_THROW(AskapComponentImager::project(images, list, options),
+                    askap::AskapError);
+        }
+
+        void testCurvedSpectrum() {
+            ComponentList list;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            const Double fluxVal = 7.0;
+            list.add(SkyComponent(Flux<casacore::Double>(fluxVal), PointShape(dir),
+                    casacore::ConstantSpectrum()));
+
+            // Replace the component's constant spectrum with a curved one
+            const Double alpha = -0.7;
+            const Double beta = -0.2;
+            const askap::components::CurvedSpectrum curved(MFrequency(Quantity(1400, "MHz")),
+                    alpha, beta);
+            const std::vector<const askap::components::SpectralModel*> models(1, &curved);
+            ProjectionOptions options;
+            options.spectralModels = &models;
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            const uInt nChan = 3;
+            TempImage<Float> image = createImage<Float>(dir, 256, 256, iquv, nChan);
+            AskapComponentImager::project(image, list, 0, options);
+            for (uInt chan = 0; chan < nChan; ++chan) {
+                const MFrequency freq(Quantity(1400.0e6 + chan * 300.0e6, "Hz"));
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(fluxVal * curved.sample(freq),
+                        image.getAt(IPosition(4, 128, 128, 0, chan)), 1e-5);
+            }
 
-                const Quantum<Double> xcellsize(5.0 * -1.0, "arcsec");
-                const Quantum<Double> ycellsize(5.0, "arcsec");
+            // Taylor term 2 includes the curvature
+            TempImage<Float> term2 = createImage<Float>(dir, 256, 256, iquv);
+            AskapComponentImager::project(term2, list, 2, options);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(fluxVal * (0.5 * alpha * (alpha - 1.0) + beta),
+                    term2.getAt(IPosition(4, 128, 128, 0, 0)), 1e-6);
+        }
 
-                const DirectionCoordinate radec(MDirection::J2000, Projection(Projection::SIN),
-                        ra, dec, xcellsize, ycellsize, xform, nx / 2, ny / 2);
+        void testPositionCache() {
+            ComponentList list = createMixedList();
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Float> uncached = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(uncached, list);
 
-                coordsys.addCoordinate(radec);
+            // The first projection converts the list, the second reuses it
+            PixelPositionCache cache;
+            ProjectionOptions options;
+            options.positionCache = &cache;
+            for (uInt i = 0; i < 2; ++i) {
+                TempImage<Float> cached = createImage<Float>(dir, 128, 128, iquv);
+                AskapComponentImager::project(cached, list, 0, options);
+                CPPUNIT_ASSERT(allEQ(uncached.get(), cached.get()));
             }
+            CPPUNIT_ASSERT_EQUAL(size_t(1), cache.misses());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), cache.hits());
 
-            // Stokes Coordinate
-            {
-                const StokesCoordinate stokescoord(stokes);
-                coordsys.addCoordinate(stokescoord);
+            // A different image grid, or a modified list, must not hit
+            TempImage<Float> larger = createImage<Float>(dir, 256, 256, iquv);
+            AskapComponentImager::project(larger, list, 0, options);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), cache.misses());
+
+            list.add(SkyComponent(Flux<casacore::Double>(1.0), PointShape(dir),
+                    casacore::ConstantSpectrum()));
+            TempImage<Float> modified = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(modified, list, 0, options);
+            CPPUNIT_ASSERT_EQUAL(size_t(3), cache.misses());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0,
+                    modified.getAt(IPosition(4, 64, 64, 0, 0)) - uncached.getAt(IPosition(4, 64, 64, 0, 0)),
+                    1e-5);
+        }
+
+        void testStats() {
+            // Components on the image, plus many more far from it
+            ComponentList list = createMixedList();
+            for (uInt i = 0; i < 200; ++i) {
+                const MDirection dir(casacore::Quantity(1.8 * i, "deg"),
+                        casacore::Quantity(-85.0 + 0.85 * i, "deg"),
+                        MDirection::J2000);
+                list.add(SkyComponent(Flux<casacore::Double>(1.0), PointShape(dir),
+                        casacore::ConstantSpectrum()));
             }
 
-            // Spectral Coordinate
-            {
-                const Quantum<Double> f0(1400.0, "MHz");
-                const Quantum<Double> inc(300.0, "MHz");
-                const Double refPix = 0.0;  // is the reference pixel
-                const SpectralCoordinate sc(MFrequency::TOPO, f0, inc, refPix);
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Float> plain = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(plain, list);
 
-                coordsys.addCoordinate(sc);
+            // Gathering statistics does not change the image, and every
+            // component is either rendered or culled
+            const ComponentIndex index(list);
+            ProjectionStats stats;
+            ProjectionOptions options;
+            options.componentIndex = &index;
+            options.stats = &stats;
+            TempImage<Float> image = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(image, list, 0, options);
+            CPPUNIT_ASSERT(allEQ(plain.get(), image.get()));
+
+            size_t total = 0;
+            for (int shape = 0; shape < ProjectionStats::N_SHAPES; ++shape) {
+                total += stats.rendered[shape] + stats.culled[shape];
             }
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(list.nelements()), total);
+            CPPUNIT_ASSERT(stats.culled[ProjectionStats::POINT] >= 195);
+            CPPUNIT_ASSERT(stats.rendered[ProjectionStats::GAUSSIAN] > 0);
+            CPPUNIT_ASSERT_EQUAL(stats.footprintPixels[ProjectionStats::GAUSSIAN],
+                    stats.pixelsEvaluated[ProjectionStats::GAUSSIAN_2D]);
+            CPPUNIT_ASSERT(stats.meanFootprint(ProjectionStats::GAUSSIAN) > 1.0);
+            CPPUNIT_ASSERT_EQUAL(1.0, stats.meanFootprint(ProjectionStats::POINT));
+            CPPUNIT_ASSERT(stats.kernelSeconds >= 0.0 && stats.imageSeconds >= 0.0);
 
-            return coordsys;
+            // The counts accumulate until reset
+            AskapComponentImager::project(image, list, 0, options);
+            CPPUNIT_ASSERT_EQUAL(2 * static_cast<size_t>(list.nelements()),
+                    stats.rendered[ProjectionStats::POINT] + stats.culled[ProjectionStats::POINT]
+                    + stats.rendered[ProjectionStats::GAUSSIAN] + stats.culled[ProjectionStats::GAUSSIAN]
+                    + stats.rendered[ProjectionStats::DISK] + stats.culled[ProjectionStats::DISK]);
+            stats.reset();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), stats.rendered[ProjectionStats::POINT]);
+            CPPUNIT_ASSERT_EQUAL(0.0, stats.imageSeconds);
         }
 
-        template <class T>
-        casacore::TempImage<T> createImage(const MDirection& dir,
-            const uInt nx, const uInt ny, const Vector<Int>& stokes) {
+        void testComponentIndex() {
+            // Components on the image, plus many more spread across the sky
+            ComponentList list = createMixedList();
+            const uInt nOnImage = list.nelements();
+            for (uInt i = 0; i < 200; ++i) {
+                const MDirection dir(casacore::Quantity(1.8 * i, "deg"),
+                        casacore::Quantity(-85.0 + 0.85 * i, "deg"),
+                        MDirection::J2000);
+                list.add(SkyComponent(Flux<casacore::Double>(1.0), PointShape(dir),
+                        casacore::ConstantSpectrum()));
+            }
 
-            // Create the image
-            IPosition imgShape(4, nx, ny, stokes.size(), 1);
-            CoordinateSystem coordsys = createCoordinateSystem(nx, ny, stokes);
-            casacore::TempImage<T> image(TiledShape(imgShape), coordsys);
-            image.set(0.0);
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Float> all = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(all, list);
+
+            // Only the components near the image are candidates, and the
+            // image is unchanged
+            const ComponentIndex index(list);
+            std::vector<uInt> candidates;
+            const CoordinateSystem& coords = all.coordinates();
+            index.query(coords.directionCoordinate(coords.findCoordinate(Coordinate::DIRECTION)),
+                    128, 128, 5.0, candidates);
+            CPPUNIT_ASSERT(candidates.size() >= nOnImage);
+            CPPUNIT_ASSERT(candidates.size() < nOnImage + 5);
+            for (uInt i = 0; i < nOnImage; ++i) {
+                CPPUNIT_ASSERT_EQUAL(i, candidates[i]);
+            }
+
+            ProjectionOptions options;
+            options.componentIndex = &index;
+            TempImage<Float> culled = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(culled, list, 0, options);
+            CPPUNIT_ASSERT(allEQ(all.get(), culled.get()));
+
+            // The index must match the list
+            const ComponentIndex other(createMixedList());
+            options.componentIndex = &other;
+            CPPUNIT_ASSERT_THROW(AskapComponentImager::project(culled, list, 0, options),
+                    askap::AskapError);
+        }
+
+        void testComponentIndexPositionCache() {
+            // A component on the far side of the sky has no pixel position
+            // on a SIN image, so converting it fails
+            ComponentList list = createMixedList();
+            const MDirection farSide(casacore::Quantity(7.5, "deg"),
+                    casacore::Quantity(45.0, "deg"),
+                    MDirection::J2000);
+            list.add(SkyComponent(Flux<casacore::Double>(1.0), PointShape(farSide),
+                    casacore::ConstantSpectrum()));
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            const ComponentIndex index(list);
+            ProjectionOptions options;
+            options.componentIndex = &index;
+            TempImage<Float> culled = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(culled, list, 0, options);
+
+            // With the cache as well only the candidates are converted, so
+            // the far side component is never converted
+            PixelPositionCache cache;
+            options.positionCache = &cache;
+            for (uInt i = 0; i < 2; ++i) {
+                TempImage<Float> cached = createImage<Float>(dir, 128, 128, iquv);
+                AskapComponentImager::project(cached, list, 0, options);
+                CPPUNIT_ASSERT(allEQ(culled.get(), cached.get()));
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(1), cache.misses());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), cache.hits());
+
+            // The entry is for the candidates only, so the whole list is
+            // not cached, and still cannot be converted
+            const CoordinateSystem& coords = culled.coordinates();
+            DirectionCoordinate dirCoord = coords.directionCoordinate(
+                    coords.findCoordinate(Coordinate::DIRECTION));
+            dirCoord.setWorldAxisUnits(Vector<String>(2, "rad"));
+            CPPUNIT_ASSERT(!cache.contains(list, dirCoord));
+            CPPUNIT_ASSERT_THROW(cache.positions(list, dirCoord), askap::AskapError);
+        }
+
+        void testMultithreaded() {
+            ComponentList list = createMixedList();
+
+            Vector<Int> iquv(4);
+            iquv(0) = Stokes::I; iquv(1) = Stokes::Q;
+            iquv(2) = Stokes::U; iquv(3) = Stokes::V;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Float> serial = createImage<Float>(dir, 128, 128, iquv, 5);
+            AskapComponentImager::project(serial, list);
+
+            // The image must be identical regardless of the number of threads
+            ProjectionOptions options;
+            options.nThreads = 4;
+            TempImage<Float> parallel = createImage<Float>(dir, 128, 128, iquv, 5);
+            AskapComponentImager::project(parallel, list, 0, options);
+            CPPUNIT_ASSERT(allEQ(serial.get(), parallel.get()));
+            CPPUNIT_ASSERT(casacore::sum(serial.get()) > 0.0);
+        }
+
+        void testChannelBlocks() {
+            ComponentList list = createMixedList();
+
+            Vector<Int> iquv(4);
+            iquv(0) = Stokes::I; iquv(1) = Stokes::Q;
+            iquv(2) = Stokes::U; iquv(3) = Stokes::V;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Float> planes = createImage<Float>(dir, 128, 128, iquv, 5);
+            planes.set(1.0);
+            AskapComponentImager::project(planes, list);
+
+            // Blocks of two channels, so the last block is partial. The
+            // components are added to the existing image, as above.
+            ProjectionOptions options;
+            options.nThreads = 2;
+            options.channelBlockMemory = 2 * 128 * 128 * 4 * sizeof(Float);
+            TempImage<Float> blocks = createImage<Float>(dir, 128, 128, iquv, 5);
+            blocks.set(1.0);
+            AskapComponentImager::project(blocks, list, 0, options);
+            CPPUNIT_ASSERT(allEQ(planes.get(), blocks.get()));
+        }
+
+        void testSparseModel() {
+            ComponentList list = createMixedList();
+
+            Vector<Int> iquv(4);
+            iquv(0) = Stokes::I; iquv(1) = Stokes::Q;
+            iquv(2) = Stokes::U; iquv(3) = Stokes::V;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Double> dense = createImage<Double>(dir, 128, 128, iquv, 3);
+            AskapComponentImager::project(dense, list);
+
+            // The sparse model only holds the pixels with flux, and when
+            // added to an empty image gives the dense result
+            TempImage<Double> merged = createImage<Double>(dir, 128, 128, iquv, 3);
+            SparseModel<Double> model(merged.shape(), merged.coordinates());
+            ProjectionOptions options;
+            options.nThreads = 2;
+            AskapComponentImager::project(model, list, 0, options);
+            CPPUNIT_ASSERT(model.nonZeros() > 0);
+            CPPUNIT_ASSERT(model.nonZeros() < merged.shape().product());
+            const std::vector<uInt>& pixels = model.pixels(1, 0);
+            for (size_t i = 1; i < pixels.size(); ++i) {
+                CPPUNIT_ASSERT(pixels[i - 1] < pixels[i]);
+            }
+
+            model.addTo(merged);
+            CPPUNIT_ASSERT(allNear(dense.get(), merged.get(), 1e-12));
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(ntrue(dense.get() != 0.0)),
+                                 model.nonZeros());
+
+            // In single precision the overlapping components are rounded
+            // as each is added, as they are in a dense image, so the result
+            // is identical
+            TempImage<Float> denseFloat = createImage<Float>(dir, 128, 128, iquv, 3);
+            AskapComponentImager::project(denseFloat, list);
+            TempImage<Float> mergedFloat = createImage<Float>(dir, 128, 128, iquv, 3);
+            SparseModel<Float> floatModel(mergedFloat.shape(), mergedFloat.coordinates());
+            AskapComponentImager::project(floatModel, list, 0, options);
+            floatModel.addTo(mergedFloat);
+            CPPUNIT_ASSERT(allEQ(denseFloat.get(), mergedFloat.get()));
+        }
+
+        void testRestoringBeam() {
+            // A gaussian restored with a circular beam is the gaussian with
+            // the beam's FWHM added in quadrature to each axis, in Jy/beam
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            const GaussianBeam beam(casacore::Quantity(20.0, "arcsec"),
+                    casacore::Quantity(20.0, "arcsec"), casacore::Quantity(0.0, "deg"));
+            const double beamArea = M_PI * 4.0 * 4.0 / (4.0 * M_LN2);
+            ComponentList list;
+            list.add(SkyComponent(Flux<casacore::Double>(2.0),
+                    GaussianShape(dir, casacore::Quantity(40.0, "arcsec"),
+                            casacore::Quantity(20.0, "arcsec"), casacore::Quantity(30, "deg")),
+                    ConstantSpectrum()));
+            ComponentList convolved;
+            convolved.add(SkyComponent(Flux<casacore::Double>(2.0 * beamArea),
+                    GaussianShape(dir, casacore::Quantity(sqrt(2000.0), "arcsec"),
+                            casacore::Quantity(sqrt(800.0), "arcsec"), casacore::Quantity(30, "deg")),
+                    ConstantSpectrum()));
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            ProjectionOptions options;
+            options.restoringBeams.assign(1, beam);
+            TempImage<Double> restored = createImage<Double>(dir, 128, 128, iquv);
+            AskapComponentImager::project(restored, list, 0, options);
+            TempImage<Double> expected = createImage<Double>(dir, 128, 128, iquv);
+            AskapComponentImager::project(expected, convolved);
+            CPPUNIT_ASSERT(allNear(expected.get(), restored.get(), 1e-9));
+
+            // A point becomes the beam of each channel, with a peak of one
+            ComponentList point;
+            point.add(SkyComponent(Flux<casacore::Double>(1.0), PointShape(dir), ConstantSpectrum()));
+            options.restoringBeams.push_back(GaussianBeam(casacore::Quantity(30.0, "arcsec"),
+                    casacore::Quantity(20.0, "arcsec"), casacore::Quantity(45.0, "deg")));
+            TempImage<Double> beams = createImage<Double>(dir, 128, 128, iquv, 2);
+            AskapComponentImager::project(beams, point, 0, options);
+            const Array<Double> values = beams.get();
+            const IPosition end(4, 127, 127, 0, 0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(beamArea,
+                    sum(values(IPosition(4, 0), end)), 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(beamArea * 1.5,
+                    sum(values(IPosition(4, 0, 0, 0, 1), IPosition(4, 127, 127, 0, 1))), 1e-6);
+            const double peak = beams.getAt(IPosition(4, 64, 64, 0, 0));
+            CPPUNIT_ASSERT(peak > 0.95 && peak < 1.0);
+
+            // A disk cannot be restored
+            options.restoringBeams.resize(1);
+            ComponentList disk;
+            disk.add(SkyComponent(Flux<casacore::Double>(1.0),
+                    DiskShape(dir, casacore::Quantity(60.0, "arcsec"),
+                            casacore::Quantity(40.0, "arcsec"), casacore::Quantity(30, "deg")),
+                    ConstantSpectrum()));
+            CPPUNIT_ASSERT_THROW(AskapComponentImager::project(restored, disk, 0, options),
+                    askap::AskapError);
+        }
+
+        void testFootprintCache() {
+            // Each gaussian appears twice, so half of the footprints are
+            // shared within the projection
+            const MDirection centre(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            ComponentList list;
+            for (uInt i = 0; i < 10; ++i) {
+                const MDirection dir(casacore::Quantity(187.5 + (i / 2) * 0.0031, "deg"),
+                        casacore::Quantity(-45.0 + (i / 2) * 0.0017, "deg"),
+                        MDirection::J2000);
+                const GaussianShape shape(dir,
+                        casacore::Quantity(20.0, "arcsec"),
+                        casacore::Quantity(12.0, "arcsec"),
+                        casacore::Quantity(30, "deg"));
+                list.add(SkyComponent(Flux<casacore::Double>(1.0 + i), shape, ConstantSpectrum()));
+            }
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            TempImage<Float> plain = createImage<Float>(centre, 128, 128, iquv);
+            AskapComponentImager::project(plain, list);
+
+            FootprintCache cache;
+            ProjectionStats stats;
+            ProjectionOptions options;
+            options.footprintCache = &cache;
+            options.stats = &stats;
+            TempImage<Float> first = createImage<Float>(centre, 128, 128, iquv);
+            AskapComponentImager::project(first, list, 0, options);
+            CPPUNIT_ASSERT_EQUAL(size_t(5), stats.footprintCacheHits);
+            CPPUNIT_ASSERT_EQUAL(size_t(5), stats.footprintCacheMisses);
+            CPPUNIT_ASSERT_EQUAL(size_t(5), cache.size());
+
+            // Rounding the centres to the subpixel grid moves the flux a
+            // little, but none is lost
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(sum(plain.get()), sum(first.get()), 1e-3);
+
+            // A second projection takes every footprint from the cache
+            TempImage<Float> second = createImage<Float>(centre, 128, 128, iquv);
+            AskapComponentImager::project(second, list, 0, options);
+            CPPUNIT_ASSERT_EQUAL(size_t(10), cache.hits());
+            CPPUNIT_ASSERT(allEQ(first.get(), second.get()));
+        }
+
+        void testFootprintCacheRestored() {
+            // A restored point is the beam, with the area of the beam as its
+            // flux. An unrestored gaussian of the same shape has the same
+            // extent with a relative cutoff, but must not share its footprint.
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            const GaussianBeam beam(casacore::Quantity(20.0, "arcsec"),
+                    casacore::Quantity(12.0, "arcsec"), casacore::Quantity(30.0, "deg"));
+            const double beamArea = M_PI * 4.0 * 2.4 / (4.0 * M_LN2);
+            ComponentList point;
+            point.add(SkyComponent(Flux<casacore::Double>(1.0), PointShape(dir), ConstantSpectrum()));
+            ComponentList gaussian;
+            gaussian.add(SkyComponent(Flux<casacore::Double>(1.0),
+                    GaussianShape(dir, beam.getMajor(), beam.getMinor(), beam.getPA()),
+                    ConstantSpectrum()));
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            FootprintCache cache;
+            ProjectionOptions options;
+            options.footprintCache = &cache;
+            options.cutoffPolicy = ProjectionOptions::RELATIVE_TO_PEAK;
+            options.cutoffValue = 1e-4;
+            options.restoringBeams.assign(1, beam);
+            TempImage<Float> restored = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(restored, point, 0, options);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(beamArea, sum(restored.get()), 1e-2);
+
+            options.restoringBeams.clear();
+            TempImage<Float> unrestored = createImage<Float>(dir, 128, 128, iquv);
+            AskapComponentImager::project(unrestored, gaussian, 0, options);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, sum(unrestored.get()), 1e-3);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), cache.hits());
+            CPPUNIT_ASSERT_EQUAL(size_t(2), cache.size());
+        }
+
+        void testCompensatedSummation() {
+            // Many faint points on top of a bright one are lost when added
+            // one at a time to a single precision image, but not when the
+            // rounding errors are carried over
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            ComponentList list;
+            list.add(SkyComponent(Flux<casacore::Double>(1.0), PointShape(dir), ConstantSpectrum()));
+            for (uInt i = 0; i < 2000; ++i) {
+                list.add(SkyComponent(Flux<casacore::Double>(1.e-8), PointShape(dir),
+                        ConstantSpectrum()));
+            }
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            const IPosition centre(4, 32, 32, 0, 0);
+
+            TempImage<Float> plain = createImage<Float>(dir, 64, 64, iquv);
+            AskapComponentImager::project(plain, list);
+            CPPUNIT_ASSERT_EQUAL(1.0f, plain.getAt(centre));
+
+            ProjectionOptions options;
+            options.compensatedSummation = true;
+            TempImage<Float> compensated = createImage<Float>(dir, 64, 64, iquv);
+            AskapComponentImager::project(compensated, list, 0, options);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0 + 2.e-5, compensated.getAt(centre), 1e-7);
+        }
+
+        void testWriteQueue() {
+            ComponentList list = createMixedList();
+
+            Vector<Int> iquv(4);
+            iquv(0) = Stokes::I; iquv(1) = Stokes::Q;
+            iquv(2) = Stokes::U; iquv(3) = Stokes::V;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Float> planes = createImage<Float>(dir, 128, 128, iquv, 5);
+            planes.set(1.0);
+            AskapComponentImager::project(planes, list);
+
+            // Blocks of one channel, with up to two waiting to be written,
+            // so every buffer set is reused
+            ProjectionOptions options;
+            options.nThreads = 2;
+            options.writeQueueDepth = 2;
+            options.channelBlockMemory = 3 * 128 * 128 * 4 * sizeof(Float);
+            TempImage<Float> queued = createImage<Float>(dir, 128, 128, iquv, 5);
+            queued.set(1.0);
+            AskapComponentImager::project(queued, list, 0, options);
+            CPPUNIT_ASSERT(allEQ(planes.get(), queued.get()));
+        }
+
+        void testCatalogue() {
+            ComponentList list = createMixedList();
+            const std::string filename = "catalogue.unittest_imager.bin";
+            ComponentCatalogue::write(filename, list);
+
+            Vector<Int> iquv(4);
+            iquv(0) = Stokes::I; iquv(1) = Stokes::Q;
+            iquv(2) = Stokes::U; iquv(3) = Stokes::V;
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            TempImage<Float> fromList = createImage<Float>(dir, 128, 128, iquv, 3);
+            AskapComponentImager::project(fromList, list);
+
+            // The catalogue holds the same components, so gives the same image
+            {
+                const ComponentCatalogue catalogue(filename);
+                TempImage<Float> fromCatalogue = createImage<Float>(dir, 128, 128, iquv, 3);
+                ProjectionOptions options;
+                options.nThreads = 2;
+                AskapComponentImager::project(fromCatalogue, catalogue, 0, options);
+                CPPUNIT_ASSERT(allNear(fromList.get(), fromCatalogue.get(), 1e-6));
+                CPPUNIT_ASSERT(casacore::sum(fromCatalogue.get()) > 0.0);
+            }
+            std::remove(filename.c_str());
+        }
+
+        void testSkewedFootprints() {
+            // An extended gaussian and disk amongst many small components,
+            // so the large footprints are split between the threads
+            ComponentList list = createMixedList();
+            const MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    MDirection::J2000);
+            list.add(SkyComponent(Flux<casacore::Double>(5.0),
+                    GaussianShape(dir, casacore::Quantity(5.0, "arcmin"),
+                            casacore::Quantity(3.0, "arcmin"), casacore::Quantity(20, "deg")),
+                    ConstantSpectrum()));
+            list.add(SkyComponent(Flux<casacore::Double>(2.0),
+                    DiskShape(dir, casacore::Quantity(4.0, "arcmin"),
+                            casacore::Quantity(2.0, "arcmin"), casacore::Quantity(60, "deg")),
+                    ConstantSpectrum()));
+            for (uInt i = 0; i < 200; ++i) {
+                const MDirection pointDir(casacore::Quantity(187.5 + (i % 20) * 0.003, "deg"),
+                        casacore::Quantity(-45.05 + (i / 20) * 0.01, "deg"),
+                        MDirection::J2000);
+                list.add(SkyComponent(Flux<casacore::Double>(0.01 * i), PointShape(pointDir),
+                        ConstantSpectrum()));
+            }
+
+            Vector<Int> iquv(1);
+            iquv(0) = Stokes::I;
+            TempImage<Double> serial = createImage<Double>(dir, 128, 128, iquv, 2);
+            AskapComponentImager::project(serial, list);
 
-            // Set brightness units
-            image.setUnits(casacore::Unit("Jy/pixel"));
-            return image;
+            ProjectionOptions options;
+            options.nThreads = 4;
+            TempImage<Double> parallel = createImage<Double>(dir, 128, 128, iquv, 2);
+            AskapComponentImager::project(parallel, list, 0, options);
+            CPPUNIT_ASSERT(allEQ(serial.get(), parallel.get()));
         }
 };
 
@@ -0,0 +1,141 @@
+/// @file ComponentCatalogueTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// System includes
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <askap/askap/AskapError.h>
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Quanta.h>
+#include <casacore/measures/Measures/MDirection.h>
+#include <casacore/measures/Measures/MFrequency.h>
+#include <casacore/measures/Measures/Stokes.h>
+#include <components/ComponentModels/SkyComponent.h>
+#include <components/ComponentModels/ComponentList.h>
+#include <components/ComponentModels/ComponentType.h>
+#include <components/ComponentModels/Flux.h>
+#include <components/ComponentModels/ConstantSpectrum.h>
+#include <components/ComponentModels/SpectralIndex.h>
+#include <components/ComponentModels/PointShape.h>
+#include <components/ComponentModels/GaussianShape.h>
+
+// Classes to test
+#include <askap/components/ComponentCatalogue.h>
+#include <askap/components/ComponentFluxTable.h>
+
+namespace askap {
+namespace components {
+
+class ComponentCatalogueTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ComponentCatalogueTest);
+        CPPUNIT_TEST(testWriteList);
+        CPPUNIT_TEST(testFluxTable);
+        CPPUNIT_TEST_EXCEPTION(testNotCatalogue, askap::AskapError);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsFilename = "catalogue.unittest.bin";
+            const casacore::MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    casacore::MDirection::J2000);
+            itsList = casacore::ComponentList();
+            itsList.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(1.0, 0.1, 0.2, 0.3),
+                    casacore::PointShape(dir), casacore::ConstantSpectrum()));
+            const casacore::GaussianShape shape(dir,
+                    casacore::Quantity(20.0, "arcsec"),
+                    casacore::Quantity(10.0, "arcsec"),
+                    casacore::Quantity(30.0, "deg"));
+            const casacore::SpectralIndex spectrum(
+                    casacore::MFrequency(casacore::Quantity(1400, "MHz")), -0.7);
+            itsList.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(2.0),
+                    shape, spectrum));
+        }
+
+        void tearDown() {
+            std::remove(itsFilename.c_str());
+        }
+
+        void testWriteList() {
+            ComponentCatalogue::write(itsFilename, itsList);
+            const ComponentCatalogue catalogue(itsFilename);
+            CPPUNIT_ASSERT_EQUAL(2u, catalogue.nelements());
+            CPPUNIT_ASSERT_EQUAL(casacore::MDirection::J2000, catalogue.directionType());
+            CPPUNIT_ASSERT_EQUAL(casacore::ComponentType::POINT, catalogue.shape(0));
+            CPPUNIT_ASSERT_EQUAL(casacore::ComponentType::GAUSSIAN, catalogue.shape(1));
+
+            const double arcsec = M_PI / (180.0 * 3600.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(187.5 * M_PI / 180.0 - 2 * M_PI, catalogue.ra()[1], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-45.0 * M_PI / 180.0, catalogue.dec()[1], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, catalogue.majorAxis()[0], 1e-20);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(20.0 * arcsec, catalogue.majorAxis()[1], 1e-15);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 * arcsec, catalogue.minorAxis()[1], 1e-15);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(M_PI / 6.0, catalogue.positionAngle()[1], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.3, catalogue.flux(casacore::Stokes::V)[0], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, catalogue.flux(casacore::Stokes::I)[1], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, catalogue.refFrequency()[0], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.4e9, catalogue.refFrequency()[1], 1e-3);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.7, catalogue.spectralIndex()[1], 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, catalogue.spectralCurvature()[1], 1e-12);
+        }
+
+        void testFluxTable() {
+            // A table built from the catalogue matches one built from the list
+            ComponentCatalogue::write(itsFilename, itsList);
+            const ComponentCatalogue catalogue(itsFilename);
+            std::vector<casacore::uInt> indices(1, 1);
+            const ComponentFluxTable fromList(itsList, indices);
+            const ComponentFluxTable fromCatalogue(catalogue, indices);
+            CPPUNIT_ASSERT_EQUAL(1u, fromCatalogue.nelements());
+            CPPUNIT_ASSERT_EQUAL(fromList.spectralKind(0), fromCatalogue.spectralKind(0));
+            CPPUNIT_ASSERT_EQUAL(fromList.flux(0, casacore::Stokes::I),
+                                 fromCatalogue.flux(0, casacore::Stokes::I));
+            CPPUNIT_ASSERT_EQUAL(fromList.alpha(0), fromCatalogue.alpha(0));
+            CPPUNIT_ASSERT_EQUAL(fromList.logRefFrequency(0), fromCatalogue.logRefFrequency(0));
+        }
+
+        void testNotCatalogue() {
+            std::ofstream out(itsFilename.c_str());
+            out << "This is not a component catalogue, but is long enough for a header";
+            out.close();
+            const ComponentCatalogue catalogue(itsFilename);
+        }
+
+    private:
+        std::string itsFilename;
+        casacore::ComponentList itsList;
+};
+
+}   // End namespace components
+}   // End namespace askap
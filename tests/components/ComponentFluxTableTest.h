@@ -0,0 +1,154 @@
+/// @file ComponentFluxTableTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// System includes
+#include <cmath>
+#include <vector>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <askap/askap/AskapError.h>
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Quanta.h>
+#include <casacore/measures/Measures/MDirection.h>
+#include <casacore/measures/Measures/MFrequency.h>
+#include <casacore/measures/Measures/Stokes.h>
+#include <components/ComponentModels/SkyComponent.h>
+#include <components/ComponentModels/ComponentList.h>
+#include <components/ComponentModels/Flux.h>
+#include <components/ComponentModels/ConstantSpectrum.h>
+#include <components/ComponentModels/SpectralIndex.h>
+#include <components/ComponentModels/PointShape.h>
+
+// Classes to test
+#include <askap/components/ComponentFluxTable.h>
+#include <askap/components/CurvedSpectrum.h>
+
+namespace askap {
+namespace components {
+
+class ComponentFluxTableTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ComponentFluxTableTest);
+        CPPUNIT_TEST(testFlux);
+        CPPUNIT_TEST(testSpectralScale);
+        CPPUNIT_TEST(testTaylorFactor);
+        CPPUNIT_TEST(testSpectralKind);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            const casacore::MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    casacore::MDirection::J2000);
+            const casacore::PointShape shape(dir);
+            itsList = casacore::ComponentList();
+
+            const casacore::Flux<casacore::Double> flux(1.0, 0.1, 0.2, 0.3);
+            itsList.add(casacore::SkyComponent(flux, shape, casacore::ConstantSpectrum()));
+
+            itsSpectrum = casacore::SpectralIndex(
+                    casacore::MFrequency(casacore::Quantity(1400, "MHz")), -0.7);
+            itsList.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(2.0),
+                    shape, itsSpectrum));
+        }
+
+        void tearDown() {
+        }
+
+        void testFlux() {
+            const ComponentFluxTable table(itsList);
+            CPPUNIT_ASSERT_EQUAL(2u, table.nelements());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, table.flux(0, casacore::Stokes::I), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.1, table.flux(0, casacore::Stokes::Q), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, table.flux(0, casacore::Stokes::U), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.3, table.flux(0, casacore::Stokes::V), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, table.flux(1, casacore::Stokes::I), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, table.flux(1, casacore::Stokes::Q), 1e-12);
+            CPPUNIT_ASSERT_THROW(table.flux(0, casacore::Stokes::XX), AskapError);
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, table.alpha(0), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.7, table.alpha(1), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.4e9, table.refFrequency(1), 1e-3);
+        }
+
+        void testSpectralScale() {
+            // The scale should match SpectralIndex::sample() for each channel
+            const ComponentFluxTable table(itsList);
+            std::vector<double> logFreqs(4);
+            for (size_t f = 0; f < logFreqs.size(); ++f) {
+                logFreqs[f] = log(1.0e9 + f * 300.0e6);
+            }
+            std::vector<double> scale(logFreqs.size());
+
+            table.spectralScale(0, logFreqs, &scale[0]);
+            for (size_t f = 0; f < scale.size(); ++f) {
+                CPPUNIT_ASSERT_EQUAL(1.0, scale[f]);
+            }
+
+            table.spectralScale(1, logFreqs, &scale[0]);
+            for (size_t f = 0; f < scale.size(); ++f) {
+                const casacore::MFrequency freq(casacore::Quantity(1.0e9 + f * 300.0e6, "Hz"));
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(itsSpectrum.sample(freq), scale[f], 1e-12);
+            }
+        }
+
+        void testTaylorFactor() {
+            const ComponentFluxTable table(itsList);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, table.taylorFactor(1, 0), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.7, table.taylorFactor(1, 1), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5 * -0.7 * -1.7, table.taylorFactor(1, 2), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, table.taylorFactor(0, 1), 1e-12);
+            CPPUNIT_ASSERT_THROW(table.taylorFactor(1, 3), AskapError);
+        }
+
+        void testSpectralKind() {
+            const ComponentFluxTable table(itsList);
+            CPPUNIT_ASSERT_EQUAL(ComponentFluxTable::FLAT, table.spectralKind(0));
+            CPPUNIT_ASSERT_EQUAL(ComponentFluxTable::POWER_LAW, table.spectralKind(1));
+
+            // Replace the model of the second component with a curved spectrum
+            const CurvedSpectrum curved(
+                    casacore::MFrequency(casacore::Quantity(1400, "MHz")), -0.7, 0.2);
+            std::vector<const SpectralModel*> models(2, static_cast<const SpectralModel*>(0));
+            models[1] = &curved;
+            std::vector<casacore::uInt> indices(2);
+            indices[0] = 0;
+            indices[1] = 1;
+            const ComponentFluxTable curvedTable(itsList, indices, models);
+            CPPUNIT_ASSERT_EQUAL(ComponentFluxTable::FLAT, curvedTable.spectralKind(0));
+            CPPUNIT_ASSERT_EQUAL(ComponentFluxTable::CURVED, curvedTable.spectralKind(1));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(log(1.4e9), curvedTable.logRefFrequency(1), 1e-12);
+        }
+
+    private:
+        casacore::ComponentList itsList;
+        casacore::SpectralIndex itsSpectrum;
+};
+
+}   // End namespace components
+}   // End namespace askap
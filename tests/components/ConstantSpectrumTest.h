@@ -0,0 +1,73 @@
+/// @file ConstantSpectrumTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <askap/askap/AskapError.h>
+
+// Classes to test
+#include <askap/components/ConstantSpectrum.h>
+
+namespace askap {
+namespace components {
+
+class ConstantSpectrumTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ConstantSpectrumTest);
+        CPPUNIT_TEST(testType);
+        CPPUNIT_TEST(testSampleBatch);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+        }
+
+        void tearDown() {
+        }
+
+        void testType() {
+            const ConstantSpectrum instance;
+            const SpectralModel& model = instance;
+            CPPUNIT_ASSERT_EQUAL(ComponentType::CONSTANT_SPECTRUM, model.type());
+        }
+
+        void testSampleBatch() {
+            const ConstantSpectrum instance;
+            double freqs[3] = {700.0e6, 1400.0e6, 2100.0e6};
+            double scale[3] = {0.0, 0.0, 0.0};
+            instance.sample(freqs, 3, scale);
+            for (int i = 0; i < 3; ++i) {
+                CPPUNIT_ASSERT_EQUAL(1.0, scale[i]);
+            }
+
+            freqs[0] = 0.0;
+            CPPUNIT_ASSERT_THROW(instance.sample(freqs, 3, scale), AskapError);
+        }
+};
+
+}   // End namespace components
+}   // End namespace askap
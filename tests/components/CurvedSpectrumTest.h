@@ -0,0 +1,107 @@
+/// @file CurvedSpectrumTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// System includes
+#include <cmath>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <askap/askap/AskapError.h>
+#include <casacore/measures/Measures/MFrequency.h>
+
+// Classes to test
+#include <askap/components/CurvedSpectrum.h>
+
+namespace askap {
+namespace components {
+
+class CurvedSpectrumTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(CurvedSpectrumTest);
+        CPPUNIT_TEST(testConstructorInvalidFreq);
+        CPPUNIT_TEST(testType);
+        CPPUNIT_TEST(testSample);
+        CPPUNIT_TEST(testSampleBatch);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+        }
+
+        void tearDown() {
+        }
+
+        void testConstructorInvalidFreq() {
+            const casacore::MFrequency zero(casacore::Quantity(0.0, "Hz"));
+            CPPUNIT_ASSERT_THROW(CurvedSpectrum(zero, -0.7, 0.1), AskapError);
+        }
+
+        void testType() {
+            const casacore::MFrequency freq(casacore::Quantity(1400, "MHz"));
+            const CurvedSpectrum instance(freq, -0.7, 0.1);
+            CPPUNIT_ASSERT_EQUAL(ComponentType::CURVED_SPECTRUM, instance.type());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.7, instance.getIndex(), 1e-15);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.1, instance.getCurvature(), 1e-15);
+        }
+
+        void testSample() {
+            const casacore::MFrequency refFreq(casacore::Quantity(1400, "MHz"));
+            const CurvedSpectrum instance(refFreq, -0.7, -0.2);
+
+            // At the reference frequency, and at twice it
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, instance.sample(refFreq), 1e-15);
+            const casacore::MFrequency doubleFreq(casacore::Quantity(2800, "MHz"));
+            const double logRatio = log(2.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(pow(2.0, -0.7 - 0.2 * logRatio),
+                    instance.sample(doubleFreq), 1e-12);
+
+            // With no curvature this is a spectral index
+            const CurvedSpectrum flat(refFreq, -0.7, 0.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(pow(2.0, -0.7), flat.sample(doubleFreq), 1e-12);
+
+            const casacore::MFrequency negative(casacore::Quantity(-10.0, "Hz"));
+            CPPUNIT_ASSERT_THROW(instance.sample(negative), AskapError);
+        }
+
+        void testSampleBatch() {
+            const casacore::MFrequency refFreq(casacore::Quantity(1400, "MHz"));
+            const CurvedSpectrum instance(refFreq, -0.7, -0.2);
+            double freqs[4] = {700.0e6, 1050.0e6, 1400.0e6, 2100.0e6};
+            double scale[4];
+            instance.sample(freqs, 4, scale);
+            for (int i = 0; i < 4; ++i) {
+                const casacore::MFrequency freq(casacore::Quantity(freqs[i], "Hz"));
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(instance.sample(freq), scale[i], 1e-12);
+            }
+
+            freqs[3] = 0.0;
+            CPPUNIT_ASSERT_THROW(instance.sample(freqs, 4, scale), AskapError);
+        }
+};
+
+}   // End namespace components
+}   // End namespace askap
@@ -0,0 +1,103 @@
+/// @file DiskEvaluatorTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// System includes
+#include <cmath>
+#include <vector>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Classes to test
+#include <askap/components/DiskEvaluator.h>
+
+namespace askap {
+namespace components {
+
+class DiskEvaluatorTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(DiskEvaluatorTest);
+        CPPUNIT_TEST(testTotalFlux);
+        CPPUNIT_TEST(testPixel);
+        CPPUNIT_TEST(testRow);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+        }
+
+        void tearDown() {
+        }
+
+        void testTotalFlux() {
+            // The flux summed over the bounding box should be the component
+            // flux, for disks both aligned with the pixel grid and rotated,
+            // and for a disk of zero width
+            const double axes[][2] = {{7.2, 3.1}, {0.5, 0.2}, {8.0, 0.0}};
+            const double pas[] = {0.0, 0.4, 1.2};
+            for (int i = 0; i < 3; ++i) {
+                const DiskEvaluator disk(10.3, 12.7, axes[i][0], axes[i][1], pas[i], 2.0);
+                double halfWidthX, halfWidthY;
+                disk.extent(halfWidthX, halfWidthY);
+                double total = 0.0;
+                for (int y = static_cast<int>(floor(12.7 - halfWidthY)) - 1;
+                        y <= static_cast<int>(ceil(12.7 + halfWidthY)) + 1; ++y) {
+                    for (int x = static_cast<int>(floor(10.3 - halfWidthX)) - 1;
+                            x <= static_cast<int>(ceil(10.3 + halfWidthX)) + 1; ++x) {
+                        total += disk.pixel(x, y);
+                    }
+                }
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, total, 1e-12);
+            }
+        }
+
+        void testPixel() {
+            // A pixel inside the disk has the surface brightness of the disk
+            const DiskEvaluator disk(0.0, 0.0, 10.0, 6.0, 0.3, 1.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0 / (M_PI * 5.0 * 3.0), disk.pixel(0, 0), 1e-15);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, disk.pixel(0, 7), 1e-15);
+
+            // A circle of unit diameter centred on the edge between two
+            // pixels is split equally between them
+            const DiskEvaluator circle(0.5, 0.0, 1.0, 1.0, 0.0, 1.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, circle.pixel(0, 0), 1e-15);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, circle.pixel(1, 0), 1e-15);
+        }
+
+        void testRow() {
+            const DiskEvaluator disk(0.3, -0.2, 9.0, 4.0, 0.6, 1.0);
+            const int halfWidth = 6;
+            std::vector<double> row(2 * halfWidth + 1);
+            for (int y = -halfWidth; y <= halfWidth; ++y) {
+                disk.row(y, -halfWidth, row.size(), &row[0]);
+                for (int x = -halfWidth; x <= halfWidth; ++x) {
+                    CPPUNIT_ASSERT_EQUAL(disk.pixel(x, y), row[x + halfWidth]);
+                }
+            }
+        }
+};
+
+}   // End namespace components
+}   // End namespace askap
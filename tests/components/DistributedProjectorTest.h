@@ -0,0 +1,242 @@
+/// @file DistributedProjectorTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// System includes
+#include <vector>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <askap/askap/AskapError.h>
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/images/Images/TempImage.h>
+#include <casacore/casa/Quanta/Quantum.h>
+#include <casacore/measures/Measures/MDirection.h>
+#include <components/ComponentModels/ComponentList.h>
+#include <components/ComponentModels/ConstantSpectrum.h>
+#include <components/ComponentModels/Flux.h>
+#include <components/ComponentModels/GaussianShape.h>
+#include <components/ComponentModels/SkyComponent.h>
+
+// Test fixtures
+#include "ProjectorTestFixture.h"
+
+// Classes to test
+#include <askap/components/DistributedProjector.h>
+#include <askap/components/AskapComponentImager.h>
+#include <askap/components/PixelPositionCache.h>
+#include <askap/components/ProjectionCommunicator.h>
+
+namespace askap {
+namespace components {
+
+class DistributedProjectorTest : public CppUnit::TestFixture, private ProjectorTestFixture {
+        CPPUNIT_TEST_SUITE(DistributedProjectorTest);
+        CPPUNIT_TEST(testChannelRange);
+        CPPUNIT_TEST(testProject);
+        CPPUNIT_TEST(testProjectSlab);
+        CPPUNIT_TEST(testCacheEviction);
+        CPPUNIT_TEST(testConversionFailure);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+        }
+
+        void tearDown() {
+        }
+
+        void testChannelRange() {
+            // 10 channels in tiles of 3 is 4 tiles, the last of which is
+            // short. With 3 ranks the first gets the spare tile.
+            casacore::uInt start;
+            casacore::uInt n;
+            DistributedProjector::channelRange(10, 3, 3, 0, start, n);
+            CPPUNIT_ASSERT_EQUAL(0u, start);
+            CPPUNIT_ASSERT_EQUAL(6u, n);
+            DistributedProjector::channelRange(10, 3, 3, 1, start, n);
+            CPPUNIT_ASSERT_EQUAL(6u, start);
+            CPPUNIT_ASSERT_EQUAL(3u, n);
+            DistributedProjector::channelRange(10, 3, 3, 2, start, n);
+            CPPUNIT_ASSERT_EQUAL(9u, start);
+            CPPUNIT_ASSERT_EQUAL(1u, n);
+
+            // More ranks than tiles leaves the last ranks with no channels
+            DistributedProjector::channelRange(10, 3, 5, 4, start, n);
+            CPPUNIT_ASSERT_EQUAL(0u, n);
+
+            CPPUNIT_ASSERT_THROW(DistributedProjector::channelRange(10, 3, 2, 2, start, n),
+                    askap::AskapError);
+        }
+
+        void testProject() {
+            // Each rank writes its channels into the same image, which must
+            // match the projection by a single process
+            const casacore::ComponentList list = createMixedList(6);
+            casacore::TempImage<casacore::Float> expected =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 10);
+            AskapComponentImager::project(expected, list);
+
+            casacore::TempImage<casacore::Float> image =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 10);
+            std::vector<double> mailbox;
+            for (int rank = 0; rank < 3; ++rank) {
+                SequentialCommunicator comm(rank, 3, mailbox);
+                DistributedProjector projector(comm);
+                projector.project(image, list);
+            }
+            CPPUNIT_ASSERT(casacore::allEQ(expected.get(), image.get()));
+        }
+
+        void testProjectSlab() {
+            // The slabs assemble into the projection by a single process,
+            // and only rank 0 converts the pixel positions
+            const casacore::ComponentList list = createMixedList(6);
+            casacore::TempImage<casacore::Float> expected =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 10);
+            AskapComponentImager::project(expected, list);
+
+            casacore::TempImage<casacore::Float> image =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 10);
+            std::vector<double> mailbox;
+            for (int rank = 0; rank < 2; ++rank) {
+                SequentialCommunicator comm(rank, 2, mailbox);
+                DistributedProjector projector(comm);
+                PixelPositionCache cache;
+                ProjectionOptions options;
+                options.positionCache = &cache;
+                casacore::IPosition start;
+                casacore::TempImage<casacore::Float> slab = projector.projectSlab<casacore::Float>(
+                        image.shape(), image.coordinates(), list, 0, options, start);
+                image.putSlice(slab.get(), start);
+                CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(rank == 0 ? 1 : 0), cache.misses());
+            }
+            CPPUNIT_ASSERT(casacore::allEQ(expected.get(), image.get()));
+        }
+
+        void testCacheEviction() {
+            // With more ranks than channels some ranks have nothing to
+            // project, so their caches discard entries in a different order
+            // to those of the ranks which do. All ranks must still take part
+            // in the same broadcasts.
+            const int nRanks = 11;
+            std::vector<casacore::ComponentList> lists;
+            for (casacore::uInt i = 0; i < 3; ++i) {
+                lists.push_back(createMixedList(6 + i));
+            }
+            const int sequence[] = {0, 1, 0, 2, 0, 1};
+
+            std::vector<double> mailbox;
+            std::vector<PixelPositionCache> caches(nRanks, PixelPositionCache(2));
+            std::vector<size_t> broadcasts(nRanks, 0);
+            for (size_t call = 0; call < sizeof(sequence) / sizeof(sequence[0]); ++call) {
+                const casacore::ComponentList& list = lists[sequence[call]];
+                casacore::TempImage<casacore::Float> expected =
+                        createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 10);
+                AskapComponentImager::project(expected, list);
+
+                casacore::TempImage<casacore::Float> image =
+                        createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 10);
+                for (int rank = 0; rank < nRanks; ++rank) {
+                    SequentialCommunicator comm(rank, nRanks, mailbox);
+                    DistributedProjector projector(comm);
+                    ProjectionOptions options;
+                    options.positionCache = &caches[rank];
+                    projector.project(image, list, 0, options);
+                    broadcasts[rank] += comm.broadcasts();
+                }
+                CPPUNIT_ASSERT(casacore::allEQ(expected.get(), image.get()));
+                for (int rank = 1; rank < nRanks; ++rank) {
+                    CPPUNIT_ASSERT_EQUAL(broadcasts[0], broadcasts[rank]);
+                }
+            }
+        }
+
+        void testConversionFailure() {
+            // A component beyond the horizon of the SIN projection has no
+            // pixel position, even with zero flux. Rank 0 fails to convert
+            // the list but must still take part in the broadcast, and then
+            // every rank throws.
+            casacore::ComponentList list = createMixedList(6);
+            const casacore::MDirection farSide(casacore::Quantity(7.5, "deg"),
+                    casacore::Quantity(45.0, "deg"),
+                    casacore::MDirection::J2000);
+            list.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(0.0),
+                    casacore::GaussianShape(farSide, casacore::Quantity(20.0, "arcsec"),
+                            casacore::Quantity(10.0, "arcsec"), casacore::Quantity(0.0, "deg")),
+                    casacore::ConstantSpectrum()));
+
+            casacore::TempImage<casacore::Float> image =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 10);
+            std::vector<double> mailbox;
+            for (int rank = 0; rank < 3; ++rank) {
+                SequentialCommunicator comm(rank, 3, mailbox);
+                DistributedProjector projector(comm);
+                CPPUNIT_ASSERT_THROW(projector.project(image, list), askap::AskapError);
+                CPPUNIT_ASSERT_EQUAL(size_t(1), comm.broadcasts());
+            }
+        }
+
+    private:
+        // A communicator for ranks which run one after the other in a single
+        // process, lowest rank first. A broadcast from rank 0 is left in the
+        // mailbox for the later ranks.
+        class SequentialCommunicator : public ProjectionCommunicator {
+            public:
+                SequentialCommunicator(const int rank, const int nRanks,
+                                       std::vector<double>& mailbox)
+                    : itsRank(rank), itsNRanks(nRanks), itsMailbox(mailbox),
+                      itsBroadcasts(0) {}
+
+                virtual int rank(void) const { return itsRank; }
+
+                virtual int nRanks(void) const { return itsNRanks; }
+
+                virtual void broadcast(std::vector<double>& values, const int root) {
+                    ++itsBroadcasts;
+                    if (itsRank == root) {
+                        itsMailbox = values;
+                    } else {
+                        values = itsMailbox;
+                    }
+                }
+
+                // @return the number of broadcasts this rank took part in
+                size_t broadcasts(void) const { return itsBroadcasts; }
+
+            private:
+                int itsRank;
+                int itsNRanks;
+                std::vector<double>& itsMailbox;
+                size_t itsBroadcasts;
+        };
+};
+
+}   // End namespace components
+}   // End namespace askap
@@ -0,0 +1,136 @@
+/// @file GaussianRowEvaluatorTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// System includes
+#include <vector>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <casacore/casa/aipstype.h>
+#include <casacore/scimath/Functionals/Gaussian2D.h>
+
+// Classes to test
+#include <askap/components/GaussianRowEvaluator.h>
+#include <askap/components/AskapComponentImager.h>
+
+namespace askap {
+namespace components {
+
+class GaussianRowEvaluatorTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(GaussianRowEvaluatorTest);
+        CPPUNIT_TEST(testSimpson);
+        CPPUNIT_TEST(testAnalytic);
+        CPPUNIT_TEST(testSimpsonSingle);
+        CPPUNIT_TEST(testReset);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+        }
+
+        void tearDown() {
+        }
+
+        void testSimpson() {
+            compareRows(ProjectionOptions::SIMPSON);
+        }
+
+        void testAnalytic() {
+            compareRows(ProjectionOptions::ANALYTIC);
+        }
+
+        void testSimpsonSingle() {
+            // Single precision samples are accurate to about 1e-6 of the flux
+            compareRows(ProjectionOptions::SIMPSON_SINGLE, ProjectionOptions::SIMPSON, 1e-7);
+        }
+
+        // An evaluator reset for a new gaussian should match one constructed
+        // for it, including when its scratch space shrinks
+        void testReset() {
+            std::vector<double> expected(7);
+            std::vector<double> row(7);
+            GaussianRowEvaluator evaluator(0.0, 0.0, 8.0, 6.0, 0.3, 2.0);
+            std::vector<double> wide(41);
+            evaluator.simpson(0, -20, wide.size(), &wide[0]);
+
+            evaluator.reset(0.4, -0.1, 3.0, 1.5, 1.1, 1.0);
+            GaussianRowEvaluator fresh(0.4, -0.1, 3.0, 1.5, 1.1, 1.0);
+            for (int y = -3; y <= 3; ++y) {
+                evaluator.simpson(y, -3, row.size(), &row[0]);
+                fresh.simpson(y, -3, expected.size(), &expected[0]);
+                for (size_t x = 0; x < row.size(); ++x) {
+                    CPPUNIT_ASSERT_EQUAL(expected[x], row[x]);
+                }
+                evaluator.analytic(y, -3, row.size(), &row[0]);
+                fresh.analytic(y, -3, expected.size(), &expected[0]);
+                for (size_t x = 0; x < row.size(); ++x) {
+                    CPPUNIT_ASSERT_EQUAL(expected[x], row[x]);
+                }
+            }
+        }
+
+    private:
+        // Each row should match the per-pixel evaluation, for gaussians both
+        // aligned with the pixel grid and rotated
+        void compareRows(const ProjectionOptions::GaussianKernel kernel) {
+            compareRows(kernel, kernel, 1e-12);
+        }
+
+        // Each row evaluated with one kernel should match the per-pixel
+        // evaluation with another, to within the tolerance
+        void compareRows(const ProjectionOptions::GaussianKernel kernel,
+                         const ProjectionOptions::GaussianKernel reference,
+                         const double tolerance) {
+            const double pas[] = {0.0, 0.6, M_PI / 2.0};
+            const int halfWidth = 10;
+            std::vector<double> row(2 * halfWidth + 1);
+            for (int i = 0; i < 3; ++i) {
+                casacore::Gaussian2D<casacore::Double> gauss(1.0, 0.3, -0.2, 4.0, 0.5, pas[i]);
+                gauss.setFlux(1.0);
+                GaussianRowEvaluator evaluator(gauss.xCenter(), gauss.yCenter(),
+                        gauss.majorAxis(), gauss.minorAxis(), gauss.PA(), gauss.flux());
+                for (int y = -halfWidth; y <= halfWidth; ++y) {
+                    if (kernel == ProjectionOptions::ANALYTIC) {
+                        evaluator.analytic(y, -halfWidth, row.size(), &row[0]);
+                    } else if (kernel == ProjectionOptions::SIMPSON_SINGLE) {
+                        evaluator.simpsonSingle(y, -halfWidth, row.size(), &row[0]);
+                    } else {
+                        evaluator.simpson(y, -halfWidth, row.size(), &row[0]);
+                    }
+                    for (int x = -halfWidth; x <= halfWidth; ++x) {
+                        const double expected = AskapComponentImager::evaluateGaussian(gauss,
+                                x, y, reference);
+                        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, row[x + halfWidth], tolerance);
+                    }
+                }
+            }
+        }
+};
+
+}   // End namespace components
+}   // End namespace askap
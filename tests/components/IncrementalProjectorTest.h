@@ -0,0 +1,119 @@
+/// @file IncrementalProjectorTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+// System includes
+#include <vector>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <askap/askap/AskapError.h>
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/images/Images/TempImage.h>
+#include <components/ComponentModels/ComponentList.h>
+
+// Test fixtures
+#include "ProjectorTestFixture.h"
+
+// Classes to test
+#include <askap/components/IncrementalProjector.h>
+#include <askap/components/AskapComponentImager.h>
+
+namespace askap {
+namespace components {
+
+class IncrementalProjectorTest : public CppUnit::TestFixture, private ProjectorTestFixture {
+        CPPUNIT_TEST_SUITE(IncrementalProjectorTest);
+        CPPUNIT_TEST(testUpdate);
+        CPPUNIT_TEST(testUnchanged);
+        CPPUNIT_TEST(testReset);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+        }
+
+        void tearDown() {
+        }
+
+        void testUpdate() {
+            // Remove one component, change the flux of another and add a
+            // third. Only those are projected, and the image must match a
+            // fresh projection of the new list.
+            casacore::TempImage<casacore::Float> image =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 4);
+            IncrementalProjector projector;
+            projector.update(image, createMixedList(6));
+            CPPUNIT_ASSERT_EQUAL(size_t(6), projector.nAdded());
+            CPPUNIT_ASSERT_EQUAL(size_t(0), projector.nRemoved());
+
+            casacore::ComponentList list = createMixedList(7);
+            list.remove(0);
+            list.component(2).flux().scaleValue(2.5);
+            projector.update(image, list);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), projector.nAdded());
+            CPPUNIT_ASSERT_EQUAL(size_t(2), projector.nRemoved());
+            CPPUNIT_ASSERT_EQUAL(size_t(6), projector.nelements());
+
+            casacore::TempImage<casacore::Float> expected =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 4);
+            AskapComponentImager::project(expected, list);
+            CPPUNIT_ASSERT(casacore::max(casacore::abs(expected.get() - image.get())) < 1e-5);
+        }
+
+        void testUnchanged() {
+            // The same list again leaves the image untouched
+            const casacore::ComponentList list = createMixedList(4);
+            casacore::TempImage<casacore::Float> image =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 4);
+            IncrementalProjector projector;
+            projector.update(image, list);
+            const casacore::Array<casacore::Float> first = image.get();
+            projector.update(image, list);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), projector.nAdded());
+            CPPUNIT_ASSERT_EQUAL(size_t(0), projector.nRemoved());
+            CPPUNIT_ASSERT(casacore::allEQ(first, image.get()));
+        }
+
+        void testReset() {
+            // After a reset every component is new again
+            const casacore::ComponentList list = createMixedList(4);
+            casacore::TempImage<casacore::Float> image =
+                    createImage<casacore::Float>(imageCentre(), 64, 64, stokesI(), 4);
+            IncrementalProjector projector;
+            projector.update(image, list);
+            projector.reset();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), projector.nelements());
+            image.set(0.0);
+            projector.update(image, list);
+            CPPUNIT_ASSERT_EQUAL(size_t(4), projector.nAdded());
+        }
+};
+
+}   // End namespace components
+}   // End namespace askap
@@ -0,0 +1,170 @@
+/// @file ProjectorTestFixture.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+#ifndef ASKAP_COMPONENTS_PROJECTORTESTFIXTURE_H
+#define ASKAP_COMPONENTS_PROJECTORTESTFIXTURE_H
+
+// Support classes
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Quanta/Quantum.h>
+#include <casacore/casa/Quanta/Unit.h>
+#include <casacore/images/Images/TempImage.h>
+#include <casacore/lattices/Lattices/TiledShape.h>
+#include <casacore/measures/Measures/MDirection.h>
+#include <casacore/measures/Measures/MFrequency.h>
+#include <casacore/measures/Measures/Stokes.h>
+#include <casacore/coordinates/Coordinates/CoordinateSystem.h>
+#include <casacore/coordinates/Coordinates/DirectionCoordinate.h>
+#include <casacore/coordinates/Coordinates/Projection.h>
+#include <casacore/coordinates/Coordinates/SpectralCoordinate.h>
+#include <casacore/coordinates/Coordinates/StokesCoordinate.h>
+#include <components/ComponentModels/ComponentList.h>
+#include <components/ComponentModels/SkyComponent.h>
+#include <components/ComponentModels/Flux.h>
+#include <components/ComponentModels/ConstantSpectrum.h>
+#include <components/ComponentModels/SpectralIndex.h>
+#include <components/ComponentModels/PointShape.h>
+#include <components/ComponentModels/GaussianShape.h>
+
+namespace askap {
+namespace components {
+
+/// @brief The component lists and images shared by the tests of
+/// AskapComponentImager and the projectors built on it. Test classes derive
+/// from this as well as from CppUnit::TestFixture.
+class ProjectorTestFixture {
+    public:
+        /// @return the centre of the images
+        static casacore::MDirection imageCentre() {
+            return casacore::MDirection(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"),
+                    casacore::MDirection::J2000);
+        }
+
+        /// @return a Stokes axis holding only I
+        static casacore::Vector<casacore::Int> stokesI() {
+            return casacore::Vector<casacore::Int>(1, casacore::Stokes::I);
+        }
+
+        /// Create a list of overlapping point and gaussian components, with a
+        /// mix of spectral models, around the centre of the image
+        static casacore::ComponentList createMixedList(const casacore::uInt n = 20) {
+            casacore::ComponentList list;
+            const casacore::SpectralIndex spectralIndex(
+                    casacore::MFrequency(casacore::Quantity(1400, "MHz")), -0.7);
+            const casacore::ConstantSpectrum constant;
+            for (casacore::uInt i = 0; i < n; ++i) {
+                const casacore::MDirection dir(casacore::Quantity(187.5 + (i % 5) * 0.002, "deg"),
+                        casacore::Quantity(-45.0 + (i / 5) * 0.002, "deg"),
+                        casacore::MDirection::J2000);
+                const casacore::Flux<casacore::Double> flux(1.0 + i, 0.1 * i, -0.05 * i, 0.0);
+                const casacore::SpectralModel& spectrum = (i % 2)
+                    ? static_cast<const casacore::SpectralModel&>(spectralIndex)
+                    : static_cast<const casacore::SpectralModel&>(constant);
+                if (i % 3) {
+                    const casacore::GaussianShape shape(dir,
+                            casacore::Quantity(10.0 + i, "arcsec"),
+                            casacore::Quantity(6.0, "arcsec"),
+                            casacore::Quantity(10.0 * i, "deg"));
+                    list.add(casacore::SkyComponent(flux, shape, spectrum));
+                } else {
+                    list.add(casacore::SkyComponent(flux, casacore::PointShape(dir), spectrum));
+                }
+            }
+            return list;
+        }
+
+        /// A SIN projection centred on imageCentre(), with 5 arcsec pixels,
+        /// followed by the Stokes axis and a spectral axis of 300 MHz
+        /// channels from 1400 MHz
+        static casacore::CoordinateSystem createCoordinateSystem(const casacore::uInt nx,
+                const casacore::uInt ny, const casacore::Vector<casacore::Int>& stokes)
+        {
+            casacore::CoordinateSystem coordsys;
+
+            // Direction Coordinate
+            {
+                casacore::Matrix<casacore::Double> xform(2, 2);
+                xform = 0.0;
+                xform.diagonal() = 1.0;
+                const casacore::Quantum<casacore::Double> ra(187.5, "deg");
+                const casacore::Quantum<casacore::Double> dec(-45.0, "deg");
+
+                const casacore::Quantum<casacore::Double> xcellsize(5.0 * -1.0, "arcsec");
+                const casacore::Quantum<casacore::Double> ycellsize(5.0, "arcsec");
+
+                const casacore::DirectionCoordinate radec(casacore::MDirection::J2000,
+                        casacore::Projection(casacore::Projection::SIN),
+                        ra, dec, xcellsize, ycellsize, xform, nx / 2, ny / 2);
+
+                coordsys.addCoordinate(radec);
+            }
+
+            // Stokes Coordinate
+            {
+                const casacore::StokesCoordinate stokescoord(stokes);
+                coordsys.addCoordinate(stokescoord);
+            }
+
+            // Spectral Coordinate
+            {
+                const casacore::Quantum<casacore::Double> f0(1400.0, "MHz");
+                const casacore::Quantum<casacore::Double> inc(300.0, "MHz");
+                const casacore::Double refPix = 0.0;  // is the reference pixel
+                const casacore::SpectralCoordinate sc(casacore::MFrequency::TOPO, f0, inc, refPix);
+
+                coordsys.addCoordinate(sc);
+            }
+
+            return coordsys;
+        }
+
+        /// An empty image with the coordinate system above
+        template <class T>
+        static casacore::TempImage<T> createImage(const casacore::MDirection& dir,
+            const casacore::uInt nx, const casacore::uInt ny,
+            const casacore::Vector<casacore::Int>& stokes,
+            const casacore::uInt nChan = 1) {
+
+            // Create the image
+            casacore::IPosition imgShape(4, nx, ny, stokes.size(), nChan);
+            casacore::CoordinateSystem coordsys = createCoordinateSystem(nx, ny, stokes);
+            casacore::TempImage<T> image(casacore::TiledShape(imgShape), coordsys);
+            image.set(0.0);
+
+            // Set brightness units
+            image.setUnits(casacore::Unit("Jy/pixel"));
+            return image;
+        }
+};
+
+}   // End namespace components
+}   // End namespace askap
+
+#endif
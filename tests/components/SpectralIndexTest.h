@@ -45,6 +45,8 @@ class SpectralIndexTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testType);
         CPPUNIT_TEST(testSample);
         CPPUNIT_TEST(testSampleInvalidArguments);
+        CPPUNIT_TEST(testSampleBatch);
+        CPPUNIT_TEST(testSampleBatchInvalidArguments);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -92,6 +94,36 @@ class SpectralIndexTest : public CppUnit::TestFixture {
             const casacore::MFrequency negative(casacore::Quantity(-10.0, "Hz"));
             CPPUNIT_ASSERT_THROW(instance.sample(negative), AskapError);
         }
+
+        void testSampleBatch() {
+            const casacore::MFrequency refFreq(casacore::Quantity(1400, "MHz"));
+            const SpectralIndex instance(refFreq, -0.7);
+            const SpectralModel& model = instance;
+
+            // Must match the single frequency sample
+            const size_t n = 5;
+            double freqs[n];
+            double scale[n];
+            for (size_t i = 0; i < n; ++i) {
+                freqs[i] = 700.0e6 + i * 350.0e6;
+            }
+            model.sample(freqs, n, scale);
+            for (size_t i = 0; i < n; ++i) {
+                const casacore::MFrequency freq(casacore::Quantity(freqs[i], "Hz"));
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(instance.sample(freq), scale[i], 1e-12);
+            }
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, scale[2], 1e-15);
+        }
+
+        void testSampleBatchInvalidArguments() {
+            const casacore::MFrequency refFreq(casacore::Quantity(1400, "MHz"));
+            const SpectralIndex instance(refFreq, 0.5);
+            double freqs[3] = {1.0e9, 0.0, 2.0e9};
+            double scale[3];
+            CPPUNIT_ASSERT_THROW(instance.sample(freqs, 3, scale), AskapError);
+            freqs[1] = -10.0;
+            CPPUNIT_ASSERT_THROW(instance.sample(freqs, 3, scale), AskapError);
+        }
 };
 
 }   // End namespace components
@@ -0,0 +1,204 @@
+/// @file VisibilityPredictorTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Ben Humphreys <ben.humphreys@csiro.au>
+
+// System includes
+#include <cmath>
+#include <complex>
+#include <vector>
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <askap/askap/AskapError.h>
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Quanta/Quantum.h>
+#include <casacore/measures/Measures/MDirection.h>
+#include <casacore/measures/Measures/Stokes.h>
+#include <components/ComponentModels/ComponentList.h>
+#include <components/ComponentModels/ConstantSpectrum.h>
+#include <components/ComponentModels/DiskShape.h>
+#include <components/ComponentModels/Flux.h>
+#include <components/ComponentModels/GaussianShape.h>
+#include <components/ComponentModels/PointShape.h>
+#include <components/ComponentModels/SkyComponent.h>
+
+// Classes to test
+#include <askap/components/VisibilityPredictor.h>
+
+namespace askap {
+namespace components {
+
+class VisibilityPredictorTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(VisibilityPredictorTest);
+        CPPUNIT_TEST(testPointAtCentre);
+        CPPUNIT_TEST(testPhase);
+        CPPUNIT_TEST(testGaussianTaper);
+        CPPUNIT_TEST(testRecurrence);
+        CPPUNIT_TEST(testUnsupportedShape);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsCentre = casacore::MDirection(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0, "deg"), casacore::MDirection::J2000);
+            itsStokes.resize(2);
+            itsStokes(0) = casacore::Stokes::I;
+            itsStokes(1) = casacore::Stokes::Q;
+        }
+
+        void tearDown() {
+        }
+
+        void testPointAtCentre() {
+            // Every visibility of a point at the phase centre is its flux
+            casacore::ComponentList list;
+            list.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(2.0, 0.5, 0.0, 0.0),
+                    casacore::PointShape(itsCentre), casacore::ConstantSpectrum()));
+            const VisibilityPredictor predictor(list, itsCentre);
+            const double uvw[] = {100.0, -250.0, 3.0, 1000.0, 20.0, -40.0};
+            const std::vector<double> freqs = channels(7);
+            std::vector<std::complex<double> > vis(2 * freqs.size() * 2);
+            predictor.predict(uvw, 2, freqs, itsStokes, &vis[0]);
+            for (size_t i = 0; i < vis.size(); i += 2) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, vis[i].real(), 1e-12);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, vis[i + 1].real(), 1e-12);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, vis[i].imag(), 1e-12);
+            }
+        }
+
+        void testPhase() {
+            // A point offset in declination has l = 0 and m = sin(offset)
+            const double offset = 0.01 * M_PI / 180.0;
+            const casacore::MDirection dir(casacore::Quantity(187.5, "deg"),
+                    casacore::Quantity(-45.0 + 0.01, "deg"), casacore::MDirection::J2000);
+            casacore::ComponentList list;
+            list.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(1.0),
+                    casacore::PointShape(dir), casacore::ConstantSpectrum()));
+            const VisibilityPredictor predictor(list, itsCentre);
+            const double m = sin(offset);
+            const double n = sqrt(1.0 - m * m);
+            const double uvw[] = {0.0, 3000.0, 50.0};
+            const std::vector<double> freqs = channels(5);
+            std::vector<std::complex<double> > vis(freqs.size() * 2);
+            predictor.predict(uvw, 1, freqs, itsStokes, &vis[0]);
+            for (size_t j = 0; j < freqs.size(); ++j) {
+                const double phase = -2.0 * M_PI * (3000.0 * m + 50.0 * (n - 1.0))
+                                     * freqs[j] / 299792458.0;
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(cos(phase), vis[2 * j].real(), 1e-9);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(sin(phase), vis[2 * j].imag(), 1e-9);
+            }
+        }
+
+        void testGaussianTaper() {
+            // With a position angle of zero the major axis is north-south, so
+            // along v, and the visibility of a gaussian at the phase centre
+            // is real and tapered by the FWHM along each baseline direction
+            const double major = 60.0 * M_PI / (180.0 * 3600.0);
+            const double minor = 30.0 * M_PI / (180.0 * 3600.0);
+            casacore::ComponentList list;
+            list.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(1.0),
+                    casacore::GaussianShape(itsCentre, casacore::Quantity(60.0, "arcsec"),
+                            casacore::Quantity(30.0, "arcsec"), casacore::Quantity(0.0, "deg")),
+                    casacore::ConstantSpectrum()));
+            const VisibilityPredictor predictor(list, itsCentre);
+            const double uvw[] = {0.0, 2000.0, 0.0, 2000.0, 0.0, 0.0};
+            const std::vector<double> freqs(1, 1.4e9);
+            std::vector<std::complex<double> > vis(2 * 2);
+            predictor.predict(uvw, 2, freqs, itsStokes, &vis[0]);
+            const double wavelengths = 2000.0 * 1.4e9 / 299792458.0;
+            const double kappa = M_PI * M_PI / (4.0 * M_LN2);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(exp(-kappa * major * major * wavelengths * wavelengths),
+                    vis[0].real(), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(exp(-kappa * minor * minor * wavelengths * wavelengths),
+                    vis[2].real(), 1e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, vis[0].imag(), 1e-12);
+        }
+
+        void testRecurrence() {
+            // The recurrence over evenly spaced channels must match the exact
+            // evaluation of each channel on its own, for any number of threads
+            casacore::ComponentList list;
+            for (casacore::uInt i = 0; i < 5; ++i) {
+                const casacore::MDirection dir(casacore::Quantity(187.5 + 0.05 * i, "deg"),
+                        casacore::Quantity(-45.0 - 0.03 * i, "deg"), casacore::MDirection::J2000);
+                if (i % 2) {
+                    list.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(1.0 + i),
+                            casacore::GaussianShape(dir, casacore::Quantity(20.0, "arcsec"),
+                                    casacore::Quantity(10.0, "arcsec"),
+                                    casacore::Quantity(30.0 * i, "deg")),
+                            casacore::ConstantSpectrum()));
+                } else {
+                    list.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(1.0 + i),
+                            casacore::PointShape(dir), casacore::ConstantSpectrum()));
+                }
+            }
+            const VisibilityPredictor predictor(list, itsCentre);
+            const double uvw[] = {1200.0, -800.0, 30.0, -300.0, 2500.0, -12.0};
+            const std::vector<double> freqs = channels(300);
+            std::vector<std::complex<double> > vis(2 * freqs.size() * 2);
+            predictor.predict(uvw, 2, freqs, itsStokes, &vis[0]);
+
+            std::vector<std::complex<double> > threaded(vis.size());
+            predictor.predict(uvw, 2, freqs, itsStokes, &threaded[0], 2);
+            for (size_t row = 0; row < 2; ++row) {
+                for (size_t j = 0; j < freqs.size(); ++j) {
+                    std::vector<std::complex<double> > single(2);
+                    predictor.predict(uvw + 3 * row, 1, std::vector<double>(1, freqs[j]),
+                            itsStokes, &single[0]);
+                    const std::complex<double>& value = vis[(row * freqs.size() + j) * 2];
+                    CPPUNIT_ASSERT(std::abs(single[0] - value) < 1e-10);
+                    CPPUNIT_ASSERT(value == threaded[(row * freqs.size() + j) * 2]);
+                }
+            }
+        }
+
+        void testUnsupportedShape() {
+            casacore::ComponentList list;
+            list.add(casacore::SkyComponent(casacore::Flux<casacore::Double>(1.0),
+                    casacore::DiskShape(itsCentre, casacore::Quantity(60.0, "arcsec"),
+                            casacore::Quantity(30.0, "arcsec"), casacore::Quantity(0.0, "deg")),
+                    casacore::ConstantSpectrum()));
+            CPPUNIT_ASSERT_THROW(VisibilityPredictor(list, itsCentre), askap::AskapError);
+        }
+
+    private:
+        // Evenly spaced channels from 1.4 GHz
+        static std::vector<double> channels(const size_t n) {
+            std::vector<double> freqs(n);
+            for (size_t j = 0; j < n; ++j) {
+                freqs[j] = 1.4e9 + j * 1.0e6;
+            }
+            return freqs;
+        }
+
+        casacore::MDirection itsCentre;
+        casacore::Vector<casacore::Stokes::StokesTypes> itsStokes;
+};
+
+}   // End namespace components
+}   // End namespace askap
@@ -29,13 +29,31 @@
 
 // Test includes
 #include "AskapComponentImagerTest.h"
+#include "ComponentCatalogueTest.h"
+#include "ComponentFluxTableTest.h"
+#include "ConstantSpectrumTest.h"
+#include "CurvedSpectrumTest.h"
+#include "DiskEvaluatorTest.h"
+#include "DistributedProjectorTest.h"
+#include "GaussianRowEvaluatorTest.h"
+#include "IncrementalProjectorTest.h"
 #include "SpectralIndexTest.h"
+#include "VisibilityPredictorTest.h"
 
 int main(int argc, char *argv[])
 {
     askapdev::testutils::AskapTestRunner runner(argv[0]);
     runner.addTest(askap::components::SpectralIndexTest::suite());
+    runner.addTest(askap::components::ConstantSpectrumTest::suite());
+    runner.addTest(askap::components::CurvedSpectrumTest::suite());
     runner.addTest(askap::components::AskapComponentImagerTest::suite());
+    runner.addTest(askap::components::GaussianRowEvaluatorTest::suite());
+    runner.addTest(askap::components::ComponentFluxTableTest::suite());
+    runner.addTest(askap::components::DiskEvaluatorTest::suite());
+    runner.addTest(askap::components::DistributedProjectorTest::suite());
+    runner.addTest(askap::components::VisibilityPredictorTest::suite());
+    runner.addTest(askap::components::IncrementalProjectorTest::suite());
+    runner.addTest(askap::components::ComponentCatalogueTest::suite());
     bool wasSucessful = runner.run();
 
     return wasSucessful ? 0 : 1;